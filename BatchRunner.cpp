@@ -0,0 +1,158 @@
+#include "BatchRunner.h"
+#include "Board.h"
+#include "GameState.h"
+#include "Tank.h"
+#include "TankAlgorithm.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+std::vector<std::string> collectBoardFiles(const std::string& source) {
+    std::vector<std::string> files;
+    fs::path sourcePath(source);
+
+    if (fs::is_directory(sourcePath)) {
+        for (const auto& entry : fs::directory_iterator(sourcePath)) {
+            if (!entry.is_regular_file()) continue;
+            std::string name = entry.path().filename().string();
+            // Skip the game's own outputs so a directory can be re-run in place
+            auto extension = entry.path().extension();
+            if ((extension != ".txt" && extension != ".tnkb") || name.rfind("output_", 0) == 0 ||
+                name == "input_errors.txt")
+                continue;
+            files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::ifstream manifest(source);
+    if (!manifest) {
+        throw std::runtime_error("Failed to open board directory or manifest: " + source);
+    }
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        fs::path boardPath(line);
+        if (boardPath.is_relative()) boardPath = sourcePath.parent_path() / boardPath;
+        files.push_back(boardPath.string());
+    }
+    return files;
+}
+
+GameSummary playHeadlessGame(const std::string& boardFile, const BatchOptions& options,
+                             StepProfiler* profile) {
+    GameSummary summary;
+    summary.boardFile = boardFile;
+
+    try {
+        Board board(boardFile);
+        GameState game(board, boardFile, options.logFormat);
+        // Games already run in parallel, so each search gets a single thread
+        AlgorithmSettings settings;
+        settings.searchMs = options.searchMs;
+        settings.searchThreads = 1;
+        auto algorithms = createTankAlgorithms(game, options.player1, options.player2, settings);
+        std::vector<Action> actions;
+
+        for (int turn = 1; !game.isGameOver() && turn <= options.maxSteps; ++turn) {
+            decideActions(game, algorithms, actions);
+            game.step(actions);
+        }
+        if (profile) profile->merge(game.getProfiler());
+
+        summary.steps = game.getStepCount();
+        if (game.isGameOver()) {
+            summary.winner = game.getWinner();
+            summary.reason = game.getResult();
+        } else {
+            summary.reason = "Step limit reached";
+        }
+    } catch (const std::exception& e) {
+        summary.failed = true;
+        summary.reason = std::string("Error: ") + e.what();
+    }
+    return summary;
+}
+
+int runBatch(const std::string& source, const BatchOptions& options) {
+    // Fail once up front rather than in every game
+    std::vector<std::string> algorithms = tankAlgorithmNames();
+    for (const std::string& name : {options.player1, options.player2}) {
+        if (std::find(algorithms.begin(), algorithms.end(), name) == algorithms.end()) {
+            throw std::runtime_error("Unknown tank algorithm: " + name);
+        }
+    }
+    if (!options.profilePath.empty() && !kProfilingEnabled) {
+        throw std::runtime_error("Profiling needs a build configured with -DTANK_PROFILE=ON");
+    }
+
+    std::vector<std::string> files = collectBoardFiles(source);
+    if (files.empty()) {
+        std::cerr << "No board files found in " << source << '\n';
+        return 1;
+    }
+
+    int threadCount = options.threads > 0 ? options.threads
+                                          : (int)std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<int>(threadCount, (int)files.size());
+
+    std::vector<GameSummary> summaries(files.size());
+    std::atomic<size_t> nextGame{0};
+    StepProfiler profile;
+    std::mutex profileMutex;
+    auto worker = [&] {
+        StepProfiler threadProfile;
+        for (size_t i = nextGame++; i < files.size(); i = nextGame++) {
+            summaries[i] = playHeadlessGame(files[i], options, &threadProfile);
+        }
+        std::lock_guard<std::mutex> lock(profileMutex);
+        profile.merge(threadProfile);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threadCount; ++t) pool.emplace_back(worker);
+    for (auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream summaryFile;
+    if (!options.summaryPath.empty()) {
+        summaryFile.open(options.summaryPath);
+        if (!summaryFile) {
+            throw std::runtime_error("Failed to open summary file: " + options.summaryPath);
+        }
+    }
+    std::ostream& out = options.summaryPath.empty() ? std::cout : summaryFile;
+
+    int failures = 0;
+    out << "board\twinner\tsteps\treason\n";
+    for (const auto& s : summaries) {
+        if (s.failed) failures++;
+        out << s.boardFile << '\t' << s.winner << '\t' << s.steps << '\t' << s.reason << '\n';
+    }
+
+    std::cerr << "Played " << files.size() << " games on " << threadCount << " threads in "
+              << seconds << " s (" << (seconds > 0 ? files.size() / seconds : 0.0) << " games/s)";
+    if (failures > 0) std::cerr << ", " << failures << " failed";
+    std::cerr << '\n';
+
+    if (!options.profilePath.empty()) {
+        std::ofstream profileFile(options.profilePath);
+        if (!profileFile) {
+            throw std::runtime_error("Failed to open profile file: " + options.profilePath);
+        }
+        profile.report(profileFile);
+    }
+    return failures > 0 ? 1 : 0;
+}
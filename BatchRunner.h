@@ -0,0 +1,40 @@
+#pragma once
+
+#include "GameLog.h"
+#include "StepProfiler.h"
+#include <string>
+#include <vector>
+
+// Outcome of one headless game, as written to the batch summary.
+struct GameSummary {
+    std::string boardFile;
+    int winner = 0;         // winning player, 0 for a tie or an unfinished game
+    int steps = 0;
+    std::string reason;     // result text from GameState, or why the game stopped
+    bool failed = false;    // board could not be loaded or the game threw
+};
+
+struct BatchOptions {
+    int threads = 0;            // 0 = one worker per hardware thread
+    int maxSteps = 200;         // same turn limit as the interactive mode
+    std::string summaryPath;    // empty = write the summary to stdout
+    LogFormat logFormat = LogFormat::TEXT;
+    std::string player1 = "chase";      // algorithm names, see createTankAlgorithm
+    std::string player2 = "reactive";   // plays every player but player 1
+    int searchMs = 50;          // per-move budget of the "search" algorithm
+    std::string profilePath;    // where to write the merged phase profile (TANK_PROFILE builds)
+};
+
+// Board files named by `source`: every *.txt or *.tnkb board in a directory, or the
+// paths listed one per line in a manifest file (blank lines and '#' comments
+// are skipped, relative paths are resolved against the manifest's directory).
+std::vector<std::string> collectBoardFiles(const std::string& source);
+
+// Plays one board to completion without rendering or user input. The game's
+// phase profile is added to `profile` if one is given.
+GameSummary playHeadlessGame(const std::string& boardFile, const BatchOptions& options,
+                             StepProfiler* profile = nullptr);
+
+// Plays every board from `source` on a pool of worker threads, writes one
+// summary line per game and reports the throughput. Returns the process exit code.
+int runBatch(const std::string& source, const BatchOptions& options);
@@ -4,78 +4,236 @@
 #include <stdexcept>
 #include "Tank.h"
 #include <sstream>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include "ByteStream.h"
+#include "MappedFile.h"
 
+static constexpr char kBinaryMagic[4] = {'T', 'N', 'K', 'B'};
+static constexpr std::uint32_t kBinaryVersion = 1;
+static constexpr size_t kBinaryHeaderSize = 16;
+// Cell byte of a tank of player p is kBinaryTankBase + p, so version 1 files
+// written for two players (3 and 4) read the same
+static constexpr unsigned char kBinaryTankBase = 2;
 
-Board::Board(const std::string& filePath) {
-    parseBoardFile(filePath);
+static std::uint32_t readU32(const unsigned char* p) {
+    return (std::uint32_t)p[0] | (std::uint32_t)p[1] << 8 | (std::uint32_t)p[2] << 16 |
+           (std::uint32_t)p[3] << 24;
+}
+
+static void writeU32(std::ostream& out, std::uint32_t v) {
+    char bytes[4] = {(char)(v & 0xFF), (char)(v >> 8 & 0xFF), (char)(v >> 16 & 0xFF), (char)(v >> 24)};
+    out.write(bytes, 4);
 }
 
+static bool validSize(int width, int height) {
+    return width > 0 && height > 0 && width <= Board::kMaxSide && height <= Board::kMaxSide;
+}
 
-void Board::parseBoardFile(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file) {
+Board::Board(const std::string& filePath) {
+    MappedFile file(filePath);
+    if (!file.isOpen()) {
         throw std::runtime_error("Failed to open board file: " + filePath);
     }
+    std::span<const unsigned char> bytes = file.bytes();
+    if (bytes.size() >= sizeof(kBinaryMagic) &&
+        std::memcmp(bytes.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0) {
+        loadBinaryBoard(bytes);
+    } else {
+        parseBoardFile(bytes);
+    }
+}
+
+Board::Board(int width, int height) : width(width), height(height) {
+    if (!validSize(width, height)) {
+        throw std::runtime_error("Invalid board size " + std::to_string(width) + "x" + std::to_string(height) + ".");
+    }
+    grid.assign((size_t)width * height, Cell{});
+}
+
+void Board::loadBinaryBoard(std::span<const unsigned char> bytes) {
+    if (bytes.size() < kBinaryHeaderSize) {
+        throw std::runtime_error("Truncated binary board header.");
+    }
+    std::uint32_t version = readU32(bytes.data() + 4);
+    std::uint32_t fileWidth = readU32(bytes.data() + 8);
+    std::uint32_t fileHeight = readU32(bytes.data() + 12);
+    if (version != kBinaryVersion) {
+        throw std::runtime_error("Unsupported binary board version " + std::to_string(version) + ".");
+    }
+    if (fileWidth == 0 || fileHeight == 0 ||
+        fileWidth > (std::uint32_t)kMaxSide || fileHeight > (std::uint32_t)kMaxSide ||
+        bytes.size() - kBinaryHeaderSize != (size_t)fileWidth * fileHeight) {
+        throw std::runtime_error("Invalid width/height declaration in binary board file.");
+    }
+
+    width = (int)fileWidth;
+    height = (int)fileHeight;
+    grid.assign((size_t)width * height, Cell{});
+
+    // Payload bytes: 0 empty, 1 wall, 2 mine, 2 + p a tank of player p
+    const unsigned char* payload = bytes.data() + kBinaryHeaderSize;
+    unsigned char highest = 0;
+    for (size_t i = 0; i < grid.size(); ++i) {
+        unsigned char value = payload[i];
+        highest = std::max(highest, value);
+        if (value > kBinaryTankBase) {
+            grid[i].content = CellContent::TANK;
+            grid[i].tankPlayer = value - kBinaryTankBase;
+            tankMarkedCells.push_back((int)i);
+        } else {
+            grid[i].content = static_cast<CellContent>(value);
+        }
+    }
+    if (highest > kBinaryTankBase + kMaxPlayers) {
+        throw std::runtime_error("Invalid cell value in binary board file.");
+    }
+}
+
+void Board::saveBinary(const std::string& filePath) const {
+    if (!validSize(width, height)) {
+        throw std::runtime_error("Board size " + std::to_string(width) + "x" + std::to_string(height) +
+                                 " does not fit the binary board format.");
+    }
+    std::ofstream out(filePath, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open binary board file for writing: " + filePath);
+    }
+    out.write(kBinaryMagic, sizeof(kBinaryMagic));
+    writeU32(out, kBinaryVersion);
+    writeU32(out, (std::uint32_t)width);
+    writeU32(out, (std::uint32_t)height);
+
+    std::vector<char> payload(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        const Cell& cell = grid[i];
+        payload[i] = cell.content == CellContent::TANK ? (char)(kBinaryTankBase + cell.tankPlayer)
+                   : cell.content == CellContent::SHELL ? (char)CellContent::EMPTY
+                                                        : (char)cell.content;
+    }
+    out.write(payload.data(), (std::streamsize)payload.size());
+    if (!out) {
+        throw std::runtime_error("Failed to write binary board file: " + filePath);
+    }
+}
+
+void Board::saveText(const std::string& filePath) const {
+    std::ofstream out(filePath, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open board file for writing: " + filePath);
+    }
+    std::string text = std::to_string(width) + " " + std::to_string(height) + "\n";
+    text.reserve(text.size() + grid.size() + height);
+    for (int y = 0; y < height; ++y) {
+        for (const Cell& cell : row(y)) {
+            switch (cell.content) {
+                case CellContent::WALL:  text += '#'; break;
+                case CellContent::MINE:  text += '@'; break;
+                case CellContent::TANK:  text += (char)('0' + cell.tankPlayer); break;
+                default:                 text += ' '; break;
+            }
+        }
+        text += '\n';
+    }
+    out.write(text.data(), (std::streamsize)text.size());
+    if (!out) {
+        throw std::runtime_error("Failed to write board file: " + filePath);
+    }
+}
+
+
+// How the text format reads each character
+enum class BoardChar : std::uint8_t { EMPTY, WALL, MINE, TANK, UNKNOWN };
+
+static constexpr std::array<BoardChar, 256> makeBoardCharTable() {
+    std::array<BoardChar, 256> table{};
+    table.fill(BoardChar::UNKNOWN);
+    table[(unsigned char)' '] = BoardChar::EMPTY;
+    table[(unsigned char)'#'] = BoardChar::WALL;
+    table[(unsigned char)'@'] = BoardChar::MINE;
+    for (char player = '1'; player <= '9'; ++player)
+        table[(unsigned char)player] = BoardChar::TANK;
+    return table;
+}
+static constexpr std::array<BoardChar, 256> kBoardChars = makeBoardCharTable();
+
+// Only the board whose warnings are being written may touch input_errors.txt
+static std::mutex errorLogMutex;
+
+// Reads a decimal int the way `istream >> int` does: leading whitespace is
+// skipped and an optional sign is accepted.
+static bool readInt(const char*& pos, const char* end, int& value) {
+    while (pos < end && std::isspace((unsigned char)*pos)) ++pos;
+    if (pos < end && *pos == '+') ++pos;
+    auto [next, ec] = std::from_chars(pos, end, value);
+    if (ec != std::errc()) return false;
+    pos = next;
+    return true;
+}
+
+// Next line as std::getline would return it (without the '\n'), or false at
+// the end of the input
+static bool nextLine(const char*& pos, const char* end, std::string_view& line) {
+    if (pos >= end) return false;
+    const char* newline = static_cast<const char*>(std::memchr(pos, '\n', (size_t)(end - pos)));
+    const char* lineEnd = newline ? newline : end;
+    line = std::string_view(pos, (size_t)(lineEnd - pos));
+    pos = newline ? newline + 1 : end;
+    return true;
+}
+
+void Board::parseBoardFile(std::span<const unsigned char> bytes) {
+    const char* pos = reinterpret_cast<const char*>(bytes.data());
+    const char* end = pos + bytes.size();
 
     int tempWidth, tempHeight;
-    if (!(file >> tempWidth >> tempHeight)) {
+    if (!readInt(pos, end, tempWidth) || !readInt(pos, end, tempHeight) || !validSize(tempWidth, tempHeight)) {
         throw std::runtime_error("Invalid width/height declaration in board file.");
     }
-    file.ignore();
+    if (pos < end) ++pos;   // the rest of the header line is the character after the height
 
     width = tempWidth;
     height = tempHeight;
-    grid.resize(height, std::vector<Cell>(width));
+    grid.assign((size_t)width * height, Cell{});
 
-    std::ofstream errorLog("input_errors.txt");
+    // Warnings are collected here and only written out if there are any
+    std::ostringstream errorLog;
     bool hasErrors = false;
 
-    int tank1Count = 0;
-    int tank2Count = 0;
-    std::string line;
+    std::string_view line;
 
     for (int y = 0; y < height; ++y) {
-        if (!std::getline(file, line)) {
+        if (!nextLine(pos, end, line)) {
             hasErrors = true;
             errorLog << "Warning: Missing row at " << y << ". Filling with EMPTY.\n";
             continue;
         }
 
-        for (int x = 0; x < width; ++x) {
-            char ch = (x < (int)line.size()) ? line[x] : ' ';
-
-            switch (ch) {
-                case '#':
-                    grid[y][x].content = CellContent::WALL;
-                    break;
-                case '@':
-                    grid[y][x].content = CellContent::MINE;
+        // Cells past the end of a short line stay EMPTY
+        Cell* row = &grid[index(0, y)];
+        int filled = std::min(width, (int)line.size());
+        for (int x = 0; x < filled; ++x) {
+            char ch = line[x];
+            switch (kBoardChars[(unsigned char)ch]) {
+                case BoardChar::EMPTY:
                     break;
-                case '1':
-                    if (tank1Count == 0) {
-                        grid[y][x].content = CellContent::TANK1;
-                        tank1Count++;
-                    } else {
-                        grid[y][x].content = CellContent::EMPTY;
-                        hasErrors = true;
-                        errorLog << "Warning: Extra Tank 1 ignored at (" << x << "," << y << ").\n";
-                    }
+                case BoardChar::WALL:
+                    row[x].content = CellContent::WALL;
                     break;
-                case '2':
-                    if (tank2Count == 0) {
-                        grid[y][x].content = CellContent::TANK2;
-                        tank2Count++;
-                    } else {
-                        grid[y][x].content = CellContent::EMPTY;
-                        hasErrors = true;
-                        errorLog << "Warning: Extra Tank 2 ignored at (" << x << "," << y << ").\n";
-                    }
+                case BoardChar::MINE:
+                    row[x].content = CellContent::MINE;
                     break;
-                case ' ':
-                    grid[y][x].content = CellContent::EMPTY;
+                case BoardChar::TANK:
+                    row[x].content = CellContent::TANK;
+                    row[x].tankPlayer = ch - '0';
+                    tankMarkedCells.push_back(index(x, y));
                     break;
-                default:
-                    grid[y][x].content = CellContent::EMPTY;
+                case BoardChar::UNKNOWN:
                     hasErrors = true;
                     errorLog << "Warning: Unknown character '" << ch << "' treated as EMPTY at (" << x << "," << y << ").\n";
                     break;
@@ -90,7 +248,7 @@ void Board::parseBoardFile(const std::string& filePath) {
 
     // Skip extra rows
     int skippedRows = 0;
-    while (std::getline(file, line)) {
+    while (nextLine(pos, end, line)) {
         skippedRows++;
     }
     if (skippedRows > 0) {
@@ -98,18 +256,78 @@ void Board::parseBoardFile(const std::string& filePath) {
         errorLog << "Warning: " << skippedRows << " extra rows ignored beyond declared height.\n";
     }
 
-    errorLog.close();
+    if (hasErrors) {
+        std::lock_guard<std::mutex> lock(errorLogMutex);
+        std::ofstream("input_errors.txt") << errorLog.str();
+    }
+}
+
 
-    if (!hasErrors) {
-        std::remove("input_errors.txt");
+void Board::serialize(ByteWriter& out) const {
+    out.i32(width);
+    out.i32(height);
+    for (const Cell& cell : grid) {
+        out.u8((std::uint8_t)cell.content);
+        out.u8((std::uint8_t)(cell.wallHits | cell.tankPlayer << 3 | cell.hasShellOverlay << 7));
     }
 }
 
+Board Board::deserialize(ByteReader& in) {
+    Board board;
+    board.width = in.i32();
+    board.height = in.i32();
+    if (!validSize(board.width, board.height)) {
+        throw std::runtime_error("Invalid board dimensions in saved data.");
+    }
+    // Take the cell bytes before sizing the grid, so truncated data fails
+    // without allocating a grid for whatever dimensions it claims
+    size_t cellCount = (size_t)board.width * board.height;
+    std::span<const unsigned char> cells = in.take(cellCount * 2);
+    board.grid.assign(cellCount, Cell{});
+    for (size_t i = 0; i < board.grid.size(); ++i) {
+        Cell& cell = board.grid[i];
+        if (cells[2 * i] > (unsigned char)CellContent::SHELL) {
+            throw std::runtime_error("Invalid cell value in saved data.");
+        }
+        cell.content = static_cast<CellContent>(cells[2 * i]);
+        cell.wallHits = cells[2 * i + 1] & 0x07;
+        cell.tankPlayer = (cells[2 * i + 1] >> 3) & 0x0F;
+        cell.hasShellOverlay = (cells[2 * i + 1] & 0x80) != 0;
+        if (cell.content == CellContent::TANK) {
+            if (cell.tankPlayer < 1 || cell.tankPlayer > kMaxPlayers) {
+                throw std::runtime_error("Invalid tank player in saved data.");
+            }
+            board.tankMarkedCells.push_back((int)i);
+        }
+        if (cell.hasShellOverlay)
+            board.shellMarkedCells.push_back((int)i);
+    }
+    return board;
+}
+
+// Terminal colour of each player's tanks
+static const char* playerColor(int player) {
+    static const char* const colors[] = {"\033[31m", "\033[34m", "\033[32m", "\033[33m", "\033[35m",
+                                         "\033[36m", "\033[91m", "\033[94m", "\033[92m"};
+    return colors[(player - 1) % 9];
+}
+
+std::string Board::print(std::span<const Tank> tanks) const {
+    // Living tanks by cell, walked in step with the rows
+    std::vector<std::pair<int, const Tank*>> tankCells;
+    for (const Tank& tank : tanks) {
+        if (tank.isAlive()) tankCells.push_back({index(tank.getPosition().first, tank.getPosition().second), &tank});
+    }
+    std::sort(tankCells.begin(), tankCells.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto nextTank = tankCells.begin();
 
-std::string Board::print(Direction dir1,Direction dir2) const {
     std::ostringstream oss;
-    for (const auto& row : grid) {
-        for (const auto& cell : row) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int i = index(x, y);
+            while (nextTank != tankCells.end() && nextTank->first < i) ++nextTank;
+            const Cell& cell = grid[i];
             std::string c = " ";
             if (cell.hasShellOverlay) {
                 c = '*';  // shell overlay takes precedence
@@ -117,8 +335,11 @@ std::string Board::print(Direction dir1,Direction dir2) const {
             switch (cell.content) {
                 case CellContent::WALL:  c = "■"; break;
                 case CellContent::MINE:  c = '@'; break;
-                case CellContent::TANK1: c = "\033[31m"+toString(dir1)+"\033[0m"; break; 
-                case CellContent::TANK2: c = "\033[34m"+toString(dir2)+"\033[0m";  break;
+                case CellContent::TANK:
+                    c = std::string(playerColor(cell.tankPlayer)) +
+                        (nextTank != tankCells.end() && nextTank->first == i ? toString(nextTank->second->getDirection()) : "?") +
+                        "\033[0m";
+                    break;
                 case CellContent::SHELL: c = "⋅"; break;
                 case CellContent::EMPTY: c = "_"; break;
             }
@@ -133,31 +354,171 @@ std::string Board::print(Direction dir1,Direction dir2) const {
 int Board::getWidth() const { return width; }
 int Board::getHeight() const { return height; }
 
-Cell Board::getCell(int x, int y) const {
-    return grid[y][x];
+void Board::setCell(int x, int y, CellContent content) {
+    writeContent(index(x, y), content);
+}
+
+void Board::setTank(int x, int y, int player) {
+    if (player < 1 || player > kMaxPlayers) {
+        throw std::invalid_argument("Player " + std::to_string(player) + " is out of range");
+    }
+    writeContent(index(x, y), CellContent::TANK, player);
 }
 
-void Board::setCell(int x, int y, CellContent content) {
-    grid[y][x].content = content;
+void Board::writeContent(int index, CellContent content, int tankPlayer) {
+    record(index);
+    CellContent old = grid[index].content;
+    if (blocksMovement(old) != blocksMovement(content) ||
+        (old == CellContent::WALL) != (content == CellContent::WALL))
+        logTerrainChange(index);
+    grid[index].content = content;
+    grid[index].tankPlayer = content == CellContent::TANK ? tankPlayer : 0;
+    if (content == CellContent::TANK)
+        tankMarkedCells.push_back(index);
+}
+
+void Board::writeShellOverlay(int index, bool overlay) {
+    record(index);
+    if (overlay && !grid[index].hasShellOverlay)
+        shellMarkedCells.push_back(index);
+    grid[index].hasShellOverlay = overlay;
+}
+
+bool Board::damageWall(int index) {
+    record(index);
+    Cell& cell = grid[index];
+    cell.wallHits++;
+    if (cell.wallHits >= 2) {
+        writeContent(index, CellContent::EMPTY);
+        return true;
+    }
+    return false;
 }
 
 void Board::clearTankMarks() {
-    for (auto& row : grid) {
-        for (auto& cell : row) {
-            if (cell.content == CellContent::TANK1 || cell.content == CellContent::TANK2)
-                cell.content = CellContent::EMPTY;
+    for (int i : tankMarkedCells) {
+        Cell& cell = grid[i];
+        if (cell.content == CellContent::TANK) {
+            record(i);
+            cell.content = CellContent::EMPTY;
+            cell.tankPlayer = 0;
+        }
+    }
+    tankMarkedCells.clear();
+}
+
+void Board::markShellCells(std::span<const int> cells, std::vector<int>& newlyMarked) {
+    for (int i : cells) {
+        if (grid[i].hasShellOverlay) continue;
+        grid[i].hasShellOverlay = true;
+        newlyMarked.push_back(i);
+    }
+}
+
+void Board::commitShellMarks(std::span<const int> newlyMarked) {
+    for (int i : newlyMarked) {
+        if (journaling) {
+            Cell old = grid[i];
+            old.hasShellOverlay = false;
+            journal.push_back({i, old, terrainBase + terrainChanges.size()});
         }
+        shellMarkedCells.push_back(i);
     }
 }
 
 void Board::clearShellMarks() {
-    for (auto& row : grid) {
-        for (auto& cell : row) {
-            cell.hasShellOverlay = false;
+    for (int i : shellMarkedCells) {
+        if (grid[i].hasShellOverlay) {
+            record(i);
+            grid[i].hasShellOverlay = false;
+        }
+    }
+    shellMarkedCells.clear();
+}
+
+// Sets a whole cell, keeping the terrain log and the mark lists right (the
+// lists may list a cell that no longer holds a mark, but never miss one)
+void Board::putCell(int index, Cell cell, bool logTerrain) {
+    CellContent old = grid[index].content;
+    if (logTerrain && (blocksMovement(old) != blocksMovement(cell.content) ||
+                       (old == CellContent::WALL) != (cell.content == CellContent::WALL)))
+        logTerrainChange(index);
+    if (cell.content == CellContent::TANK)
+        tankMarkedCells.push_back(index);
+    if (cell.hasShellOverlay)
+        shellMarkedCells.push_back(index);
+    grid[index] = cell;
+}
+
+// Drops the oldest half once the log holds twice what it must keep, so each
+// change is moved at most once
+void Board::logTerrainChange(int index) {
+    terrainChanges.push_back(index);
+    std::size_t keep = std::max(grid.size(), kMinTerrainLog);
+    if (terrainChanges.size() >= 2 * keep) {
+        std::size_t drop = terrainChanges.size() - keep;
+        terrainChanges.erase(terrainChanges.begin(), terrainChanges.begin() + (std::ptrdiff_t)drop);
+        terrainBase += drop;
+    }
+}
+
+std::uint64_t Board::terrainLogEnd() const {
+    std::uint64_t end = terrainBase + terrainChanges.size();
+    terrainReadMark = std::max(terrainReadMark, end);
+    return end;
+}
+
+bool Board::terrainChangesSince(std::uint64_t cursor, std::span<const int>& changes) const {
+    std::uint64_t end = terrainLogEnd();
+    if (cursor < terrainBase || cursor > end) return false;
+    changes = std::span<const int>(terrainChanges).subspan((std::size_t)(cursor - terrainBase));
+    return true;
+}
+
+void Board::resetTerrainChanges() {
+    terrainBase += terrainChanges.size();
+    terrainChanges.clear();
+}
+
+void Board::setJournaling(bool enabled) {
+    journaling = enabled;
+    if (!enabled) journal.clear();
+}
+
+void Board::rollbackJournal(size_t size) {
+    if (journal.size() <= size) return;
+    // Every terrain change since the first undone write is undone with it. If
+    // no reader got that far, the log is cut back and the undo leaves no
+    // trace; otherwise undone writes are logged like new ones, so readers
+    // with a cursor past the cut see them.
+    std::uint64_t cut = journal[size].terrainEnd;
+    bool unread = terrainReadMark <= cut && cut >= terrainBase;
+    if (unread) terrainChanges.resize((std::size_t)(cut - terrainBase));
+    while (journal.size() > size) {
+        const JournalEntry& entry = journal.back();
+        putCell(entry.index, entry.old, !unread);
+        journal.pop_back();
+    }
+}
+
+void Board::restoreCells(const std::vector<Cell>& cells) {
+    if (cells.size() != grid.size()) {
+        throw std::invalid_argument("Snapshot does not match the board size");
+    }
+    for (size_t i = 0; i < grid.size(); ++i) {
+        const Cell& cell = cells[i];
+        if (cell != grid[i]) {
+            record((int)i);
+            putCell((int)i, cell);
         }
     }
 }
 
+const SightTable& Board::sightTable() const {
+    sight.sync(*this);
+    return sight;
+}
+
 void Board::wrapCoords(int& x, int& y) const {
     x = (x + width) % width;
     y = (y + height) % height;
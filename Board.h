@@ -2,39 +2,189 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <span>
 #include "Tank.h"
-enum class CellContent {
+#include "SightTable.h"
+enum class CellContent : std::uint8_t {
     EMPTY,
     WALL,
     MINE,
-    TANK1,
-    TANK2,
+    TANK,    // owner in Cell::tankPlayer
     SHELL
 };
 
+// Packed into two bytes so that large boards stay cache friendly.
 struct Cell {
     CellContent content = CellContent::EMPTY;
-    int wallHits = 0;
-    bool hasShellOverlay = false;  
+    std::uint8_t wallHits : 3 = 0;
+    std::uint8_t tankPlayer : 4 = 0;   // player (1-9) of the tank in the cell, 0 otherwise
+    bool hasShellOverlay : 1 = false;
+
+    bool operator==(const Cell&) const = default;
+};
+static_assert(sizeof(Cell) == 2, "Cell is expected to pack into two bytes");
+
+// Walls and mines are the only contents a tank can't drive through
+inline bool blocksMovement(CellContent content) {
+    return content == CellContent::WALL || content == CellContent::MINE;
+}
+
+class Board;
+class ByteWriter;
+class ByteReader;
+
+// Mutable handle to one cell. Writes go through the Board so that it stays
+// the only place that changes cell state.
+class CellHandle {
+public:
+    CellHandle(Board& board, int index) : board(board), idx(index) {}
+
+    const Cell& get() const;
+    CellContent content() const { return get().content; }
+    int index() const { return idx; }
+
+    void setContent(CellContent content);
+    void setShellOverlay(bool overlay);
+    // Registers a shell hit on a wall; returns true if the wall was destroyed.
+    bool damageWall();
+
+private:
+    Board& board;
+    int idx;
 };
 
 class Board {
 public:
     friend int main(int argc, char* argv[]);
+    friend class CellHandle;
     
+    // Loads a text board, or a binary one (see saveBinary) if the file starts
+    // with the binary magic
     Board(const std::string& filePath);
-    std::string print(Direction dir1,Direction dir2) const;
+    // Empty board of the given size (1 to kMaxSide cells a side)
+    Board(int width, int height);
+
+    // Every board, whatever it is loaded from, is 1 to kMaxSide cells a side
+    static constexpr int kMaxSide = 0xFFFF;
+
+    // Players are numbered 1 to kMaxPlayers, the digits of the text format;
+    // each may have any number of tanks
+    static constexpr int kMaxPlayers = 9;
+    // Writes the cell contents in the binary board format:
+    //   "TNKB", u32 version, u32 width, u32 height (little-endian), then one
+    //   byte per cell, row-major: 0 empty, 1 wall, 2 mine, 2 + p a tank of
+    //   player p. Wall damage and shells are not kept.
+    // Throws std::runtime_error for a board the loader couldn't read back.
+    void saveBinary(const std::string& filePath) const;
+    // Writes the cell contents in the text format the constructor parses
+    void saveText(const std::string& filePath) const;
+
+    // Complete cell state, wall damage and shell overlays included, for
+    // replay keyframes. A restored board starts a fresh terrain-change log.
+    void serialize(ByteWriter& out) const;
+    static Board deserialize(ByteReader& in);
+    // The board as shown to people; tank cells show the direction of the
+    // tank in `tanks` standing there, in its player's colour
+    std::string print(std::span<const Tank> tanks) const;
     int getWidth() const;
     int getHeight() const;
-    Cell getCell(int x, int y) const;
+    int getCellCount() const { return (int)grid.size(); }
+
+    // Position of (x, y) in the row-major grid
+    int index(int x, int y) const { return y * width + x; }
+    const Cell& getCell(int x, int y) const { return grid[index(x, y)]; }
+    const Cell& getCell(int index) const { return grid[index]; }
+    std::span<const Cell> row(int y) const { return {grid.data() + index(0, y), (size_t)width}; }
+    CellHandle cell(int x, int y) { return CellHandle(*this, index(x, y)); }
+    CellHandle cell(int index) { return CellHandle(*this, index); }
+
     void setCell(int x, int y, CellContent content);
+    void setTank(int x, int y, int player);
     void clearTankMarks();
     void clearShellMarks();
+    // Shell overlays set from several threads: markShellCells() may run
+    // concurrently on disjoint sets of cells and collects the cells it newly
+    // marked; commitShellMarks() then registers them (mark list, undo
+    // journal) on one thread. Same cells as setShellOverlay(true) in a loop.
+    void markShellCells(std::span<const int> cells, std::vector<int>& newlyMarked);
+    void commitShellMarks(std::span<const int> newlyMarked);
     void wrapCoords(int& x, int& y) const;
 
-    std::vector<std::vector<Cell>> grid;
+    // Terrain log: cells that gained or lost a wall, or switched between
+    // blocking and non-blocking (see blocksMovement), in the order it
+    // happened. Positions in it are absolute and only grow, so a reader keeps
+    // a cursor and asks for what came after it. The log is bounded: it keeps
+    // at least the last max(cell count, kMinTerrainLog) changes, and a reader
+    // that fell further behind must rebuild from the cells, which costs about
+    // as much as replaying that many changes would have.
+    //
+    // Position just past the last change; a reader that has just built its
+    // state from the cells takes it as its cursor
+    std::uint64_t terrainLogEnd() const;
+    // The changes from `cursor` up to terrainLogEnd(), or false if some of
+    // them have been dropped and the reader has to rebuild
+    bool terrainChangesSince(std::uint64_t cursor, std::span<const int>& changes) const;
+    // Drops the whole log; readers rebuild on their next use. For boards
+    // nobody has read yet (generated boards).
+    void resetTerrainChanges();
+    static constexpr std::size_t kMinTerrainLog = 1024;
+
+    // Wall distances along the 8 firing rays, built on first use and brought
+    // up to date with the terrain changes on every call
+    const SightTable& sightTable() const;
+
+    // Undo journal for search. While it is on, every cell write first records
+    // the cell's old value, and rollbackJournal(size) puts back every cell
+    // written since journalSize() returned `size`. Turning it off drops it.
+    // A rollback only leaves terrain log entries behind if a reader has read
+    // the changes being undone; otherwise the log is cut back as if they had
+    // never happened.
+    void setJournaling(bool enabled);
+    size_t journalSize() const { return journal.size(); }
+    void rollbackJournal(size_t size);
+
+    // The whole grid, for value snapshots; restoreCells() takes a grid of the
+    // same size back (journaled like any other write)
+    const std::vector<Cell>& cells() const { return grid; }
+    void restoreCells(const std::vector<Cell>& cells);
 
 private:
+    Board() = default;
+
     int width = 0, height = 0;
-    void parseBoardFile(const std::string& filePath);
+    std::vector<Cell> grid;  // width * height cells, row-major
+    // Cells that may hold a tank mark or a shell overlay, so that clearing
+    // them costs as much as the number of entities rather than the board area
+    std::vector<int> tankMarkedCells;
+    std::vector<int> shellMarkedCells;
+    std::vector<int> terrainChanges;
+    std::uint64_t terrainBase = 0;              // absolute position of terrainChanges[0]
+    mutable std::uint64_t terrainReadMark = 0;  // furthest position handed to a reader
+    mutable SightTable sight;
+
+    struct JournalEntry {
+        int index;
+        Cell old;
+        std::uint64_t terrainEnd;   // terrain log end before the write
+    };
+    std::vector<JournalEntry> journal;
+    bool journaling = false;
+
+    void record(int index) {
+        if (journaling) journal.push_back({index, grid[index], terrainBase + terrainChanges.size()});
+    }
+    void putCell(int index, Cell cell, bool logTerrain = true);
+    void logTerrainChange(int index);
+
+    void parseBoardFile(std::span<const unsigned char> bytes);
+    void loadBinaryBoard(std::span<const unsigned char> bytes);
+    void writeContent(int index, CellContent content, int tankPlayer = 0);
+    void writeShellOverlay(int index, bool overlay);
+    bool damageWall(int index);
 };
+
+inline const Cell& CellHandle::get() const { return board.grid[idx]; }
+inline void CellHandle::setContent(CellContent content) { board.writeContent(idx, content); }
+inline void CellHandle::setShellOverlay(bool overlay) { board.writeShellOverlay(idx, overlay); }
+inline bool CellHandle::damageWall() { return board.damageWall(idx); }
@@ -0,0 +1,230 @@
+#include "BoardGenerator.h"
+#include "BoardGeometry.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// splitmix64: tiny, and the sequence for a seed never depends on the platform
+class GeneratorRandom {
+public:
+    explicit GeneratorRandom(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // Uniform enough in [0, bound) for bounds far below 2^64
+    int below(int bound) { return (int)(next() % (std::uint64_t)bound); }
+    bool percent(int p) { return below(100) < p; }
+
+private:
+    std::uint64_t state;
+};
+
+bool isBorder(const BoardSpec& spec, int x, int y) {
+    return x == 0 || y == 0 || x == spec.width - 1 || y == spec.height - 1;
+}
+
+bool hasBorder(const BoardSpec& spec) {
+    return spec.borderWalls || spec.layout == BoardLayout::MAZE;
+}
+
+// Straight segments of 1 to 8 walls until about wallPercent of the cells are walls
+// (besides any border)
+void buildArena(Board& board, const BoardSpec& spec, GeneratorRandom& rng) {
+    long long target = (long long)spec.width * spec.height * spec.wallPercent / 100;
+    long long walls = 0;   // the border ring doesn't count
+
+    // Attempts are bounded so a nearly full board can't stall the loop
+    for (long long attempts = target * 4; walls < target && attempts > 0; --attempts) {
+        int x = rng.below(spec.width);
+        int y = rng.below(spec.height);
+        Direction dir = static_cast<Direction>(rng.below(4) * 2);   // U, R, D or L
+        for (int length = 1 + rng.below(8); length > 0 && walls < target; --length) {
+            if (board.getCell(x, y).content == CellContent::EMPTY) {
+                board.setCell(x, y, CellContent::WALL);
+                ++walls;
+            }
+            stepWrapped(board, x, y, dir);
+        }
+    }
+}
+
+// Depth-first maze over the cells with odd coordinates; the cells between
+// two of them are the walls that get carved through. The outer ring is never
+// carved, so a maze always has a border.
+void buildMaze(Board& board, const BoardSpec& spec, GeneratorRandom& rng) {
+    for (int y = 0; y < spec.height; ++y)
+        for (int x = 0; x < spec.width; ++x)
+            board.setCell(x, y, CellContent::WALL);
+
+    int roomsX = (spec.width - 1) / 2;
+    int roomsY = (spec.height - 1) / 2;
+    static constexpr int kDx[4] = {0, 1, 0, -1};
+    static constexpr int kDy[4] = {-1, 0, 1, 0};
+
+    std::vector<int> stack = {0};
+    board.setCell(1, 1, CellContent::EMPTY);
+    while (!stack.empty()) {
+        int room = stack.back();
+        int rx = room % roomsX, ry = room / roomsX;
+        int options[4];
+        int count = 0;
+        for (int d = 0; d < 4; ++d) {
+            int nx = rx + kDx[d], ny = ry + kDy[d];
+            if (nx >= 0 && ny >= 0 && nx < roomsX && ny < roomsY &&
+                board.getCell(2 * nx + 1, 2 * ny + 1).content == CellContent::WALL)
+                options[count++] = d;
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int d = options[rng.below(count)];
+        board.setCell(2 * rx + 1 + kDx[d], 2 * ry + 1 + kDy[d], CellContent::EMPTY);
+        board.setCell(2 * (rx + kDx[d]) + 1, 2 * (ry + kDy[d]) + 1, CellContent::EMPTY);
+        stack.push_back((ry + kDy[d]) * roomsX + rx + kDx[d]);
+    }
+
+    // Walls separating two corridors; removing some turns the tree into loops
+    for (int y = 1; y < 2 * roomsY; ++y) {
+        for (int x = 1; x < 2 * roomsX; ++x) {
+            if ((x + y) % 2 == 1 && board.getCell(x, y).content == CellContent::WALL && rng.percent(spec.loopPercent))
+                board.setCell(x, y, CellContent::EMPTY);
+        }
+    }
+}
+
+void placeMines(Board& board, const BoardSpec& spec, GeneratorRandom& rng) {
+    if (spec.minePercent == 0) return;
+    for (int y = 0; y < spec.height; ++y)
+        for (int x = 0; x < spec.width; ++x)
+            if (board.getCell(x, y).content == CellContent::EMPTY && rng.percent(spec.minePercent))
+                board.setCell(x, y, CellContent::MINE);
+}
+
+// Chebyshev distance on the torus
+int wrappedDistance(const BoardSpec& spec, Position a, Position b) {
+    return std::max(std::abs(wrappedDelta(a.first, b.first, spec.width)),
+                    std::abs(wrappedDelta(a.second, b.second, spec.height)));
+}
+
+// Random spot at least a quarter of the smaller side away from the tanks
+// placed so far, or just a free one after 1000 tries
+Position randomTankPosition(const BoardSpec& spec, const std::vector<Position>& placed, GeneratorRandom& rng) {
+    int w = spec.width, h = spec.height;
+    int minApart = std::min(w, h) / 4;
+    auto draw = [&] { return Position{1 + rng.below(w - 2), 1 + rng.below(h - 2)}; };
+    Position at = draw();
+    for (int attempt = 1; attempt < 1000 && !placed.empty(); ++attempt) {
+        bool farEnough = std::all_of(placed.begin(), placed.end(),
+                                     [&](Position other) { return wrappedDistance(spec, at, other) >= minApart; });
+        if (farEnough) return at;
+        at = draw();
+    }
+    while (std::find(placed.begin(), placed.end(), at) != placed.end()) at = draw();
+    return at;
+}
+
+// Tank positions, kept off the border ring, in the order tanks are dealt
+std::vector<Position> tankPositions(const BoardSpec& spec, int count, GeneratorRandom& rng) {
+    int w = spec.width, h = spec.height;
+    std::vector<Position> positions;
+    switch (spec.tanks) {
+        case TankPlacement::CORNERS: {
+            const Position corners[4] = {{1, 1}, {w - 2, h - 2}, {w - 2, 1}, {1, h - 2}};
+            if (count > 4) throw std::runtime_error("Corner placement takes at most 4 tanks.");
+            positions.assign(corners, corners + count);
+            break;
+        }
+        case TankPlacement::RANDOM:
+            while ((int)positions.size() < count) positions.push_back(randomTankPosition(spec, positions, rng));
+            break;
+        case TankPlacement::SPREAD:
+        default: {
+            // The smallest square lattice that fits, each column shifted down
+            // one row from the last so that two tanks end up diagonally apart
+            int side = 1;
+            while (side * side < count) ++side;
+            for (int t = 0; t < count; ++t) {
+                int column = t % side, row = (t / side + column) % side;
+                int x = std::clamp((2 * column + 1) * w / (2 * side), 1, w - 2);
+                int y = std::clamp((2 * row + 1) * h / (2 * side), 1, h - 2);
+                if (std::find(positions.begin(), positions.end(), Position{x, y}) != positions.end()) {
+                    throw std::runtime_error("The board is too small to spread " + std::to_string(count) + " tanks.");
+                }
+                positions.push_back({x, y});
+            }
+            break;
+        }
+    }
+    return positions;
+}
+
+void placeTank(Board& board, const BoardSpec& spec, Position at, int player) {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            int x = wrapCoord(at.first + dx, spec.width);
+            int y = wrapCoord(at.second + dy, spec.height);
+            if (hasBorder(spec) && isBorder(spec, x, y)) continue;
+            CellContent content = board.getCell(x, y).content;
+            if (content == CellContent::WALL || content == CellContent::MINE)
+                board.setCell(x, y, CellContent::EMPTY);
+        }
+    }
+    board.setTank(at.first, at.second, player);
+}
+
+void checkPercent(int value, int max, const char* what) {
+    if (value < 0 || value > max) {
+        throw std::runtime_error(std::string(what) + " must be between 0 and " + std::to_string(max) + ".");
+    }
+}
+
+}  // namespace
+
+Board generateBoard(const BoardSpec& spec) {
+    if (spec.width < BoardSpec::kMinSize || spec.height < BoardSpec::kMinSize ||
+        spec.width > BoardSpec::kMaxSize || spec.height > BoardSpec::kMaxSize) {
+        throw std::runtime_error("Generated boards must be between " + std::to_string(BoardSpec::kMinSize) +
+                                 " and " + std::to_string(BoardSpec::kMaxSize) + " cells a side.");
+    }
+    checkPercent(spec.wallPercent, 90, "Wall percentage");
+    checkPercent(spec.loopPercent, 100, "Loop percentage");
+    checkPercent(spec.minePercent, 50, "Mine percentage");
+    if (spec.players < 2 || spec.players > Board::kMaxPlayers) {
+        throw std::runtime_error("Players must be between 2 and " + std::to_string(Board::kMaxPlayers) + ".");
+    }
+    // Tanks stay off the border ring and need distinct cells
+    long long tankCount = (long long)spec.players * spec.tanksPerPlayer;
+    if (spec.tanksPerPlayer < 1 || tankCount > (long long)(spec.width - 2) * (spec.height - 2)) {
+        throw std::runtime_error("Tanks per player must be at least 1, and the tanks must fit on the board.");
+    }
+
+    GeneratorRandom rng(spec.seed);
+    Board board(spec.width, spec.height);
+    if (spec.layout == BoardLayout::MAZE) {
+        buildMaze(board, spec, rng);
+    } else {
+        if (spec.borderWalls) {
+            for (int y = 0; y < spec.height; ++y)
+                for (int x = 0; x < spec.width; ++x)
+                    if (isBorder(spec, x, y)) board.setCell(x, y, CellContent::WALL);
+        }
+        buildArena(board, spec, rng);
+    }
+    placeMines(board, spec, rng);
+
+    std::vector<Position> positions = tankPositions(spec, (int)tankCount, rng);
+    for (int t = 0; t < (int)positions.size(); ++t) placeTank(board, spec, positions[t], t % spec.players + 1);
+
+    // Nobody has read the board yet, so the changes made here needn't be kept
+    board.resetTerrainChanges();
+    return board;
+}
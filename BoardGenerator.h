@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Board.h"
+#include <cstdint>
+
+// Seeded procedural boards for scale and stress tests. The same spec always
+// gives the same board, on every platform.
+
+enum class BoardLayout {
+    ARENA,   // open floor with straight wall segments scattered over it
+    MAZE     // corridors one cell wide inside a wall ring, optionally with loops
+};
+
+enum class TankPlacement {
+    SPREAD,   // on an even lattice; two tanks are a quarter of the board apart on each axis
+    CORNERS,  // in the corners, which are close across the wrapped edges (at most 4 tanks)
+    RANDOM    // anywhere, at least a quarter of the smaller side apart when there is room
+};
+
+struct BoardSpec {
+    static constexpr int kMinSize = 5;
+    static constexpr int kMaxSize = 4096;
+
+    int width = 64;
+    int height = 64;
+    BoardLayout layout = BoardLayout::ARENA;
+    int wallPercent = 15;     // arena: share of cells that are walls (at most 90)
+    int loopPercent = 10;     // maze: share of inner maze walls removed to make loops
+    int minePercent = 2;      // share of the remaining floor that holds mines
+    bool borderWalls = false; // arena: wall in the outer ring, so nothing wraps around
+    TankPlacement tanks = TankPlacement::SPREAD;
+    int players = 2;          // 2 to Board::kMaxPlayers
+    int tanksPerPlayer = 1;   // tanks are dealt to the players in turn
+    std::uint64_t seed = 1;
+};
+
+// Builds the board described by `spec`. Each tank gets a clear 3x3 area
+// around it; the tanks are not guaranteed to be able to reach each other.
+// Throws std::runtime_error for sizes, percentages or tank counts out of range.
+Board generateBoard(const BoardSpec& spec);
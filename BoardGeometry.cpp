@@ -0,0 +1,81 @@
+#include "BoardGeometry.h"
+#include "Board.h"
+
+int wrappedDelta(int from, int to, int size) {
+    int d = wrapCoord(to - from, size);
+    return d > size / 2 ? d - size : d;
+}
+
+bool stepWrapped(const Board& board, int& x, int& y, Direction dir) {
+    int nx = x + kDirDx[static_cast<int>(dir)];
+    int ny = y + kDirDy[static_cast<int>(dir)];
+    bool crossed = nx < 0 || nx >= board.getWidth() || ny < 0 || ny >= board.getHeight();
+    if (crossed) {
+        nx = wrapCoord(nx, board.getWidth());
+        ny = wrapCoord(ny, board.getHeight());
+    }
+    x = nx;
+    y = ny;
+    return crossed;
+}
+
+Position wrappedNeighbor(const Board& board, Position p, Direction dir) {
+    stepWrapped(board, p.first, p.second, dir);
+    return p;
+}
+
+Direction directionTowards(const Board& board, Position from, Position to) {
+    int dx = wrappedDelta(from.first, to.first, board.getWidth());
+    int dy = wrappedDelta(from.second, to.second, board.getHeight());
+    dx = (dx > 0) - (dx < 0);
+    dy = (dy > 0) - (dy < 0);
+    for (int d = 0; d < 8; ++d) {
+        if (kDirDx[d] == dx && kDirDy[d] == dy)
+            return static_cast<Direction>(d);
+    }
+    return Direction::U;
+}
+
+// Smallest k >= 0 with k = a (mod m) and k = b (mod n), or -1 if there is none
+static long long solveCongruences(long long a, long long m, long long b, long long n) {
+    // Extended Euclid: p * m + q * n = g
+    long long oldR = m, r = n, oldP = 1, p = 0;
+    while (r != 0) {
+        long long quotient = oldR / r;
+        long long t = oldR - quotient * r; oldR = r; r = t;
+        t = oldP - quotient * p; oldP = p; p = t;
+    }
+    long long g = oldR;
+    if ((b - a) % g != 0)
+        return -1;
+    long long lcm = m / g * n;
+    long long step = ((b - a) / g) % (n / g) * (oldP % (n / g)) % (n / g);
+    long long k = (a + m * step) % lcm;
+    return k < 0 ? k + lcm : k;
+}
+
+int rayDistance(const Board& board, Position from, Position to, Direction dir) {
+    int width = board.getWidth(), height = board.getHeight();
+    int sx = kDirDx[static_cast<int>(dir)];
+    int sy = kDirDy[static_cast<int>(dir)];
+    if (from == to)
+        return -1;
+    if (sx == 0 && from.first != to.first)
+        return -1;
+    if (sy == 0 && from.second != to.second)
+        return -1;
+
+    long long k;
+    if (sx == 0)
+        k = wrapCoord((to.second - from.second) * sy, height);
+    else if (sy == 0)
+        k = wrapCoord((to.first - from.first) * sx, width);
+    else
+        k = solveCongruences(wrapCoord((to.first - from.first) * sx, width), width,
+                             wrapCoord((to.second - from.second) * sy, height), height);
+    return (int)k;
+}
+
+std::optional<Direction> lineOfSightDirection(const Board& board, Position from, Position to) {
+    return board.sightTable().firingDirection(board, from, to);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Tank.h"
+#include <optional>
+#include <utility>
+
+class Board;
+
+using Position = std::pair<int, int>;
+
+// Board topology shared by the simulation and the algorithms. The board is a
+// torus: a move off one edge re-enters on the opposite edge, and only walls
+// stop it (an intact border wall therefore blocks the crossing).
+
+// Unit offsets of the 8 directions, indexed by Direction
+inline constexpr int kDirDx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+inline constexpr int kDirDy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+inline int wrapCoord(int v, int size) {
+    v %= size;
+    return v < 0 ? v + size : v;
+}
+
+// Shortest signed distance from `from` to `to` on a ring of `size` cells
+int wrappedDelta(int from, int to, int size);
+
+// Moves (x, y) one cell in direction `dir`, re-entering on the opposite edge
+// when it leaves the board. Returns true if an edge was crossed.
+bool stepWrapped(const Board& board, int& x, int& y, Direction dir);
+
+// Cell next to `p` in direction `dir` on the torus
+Position wrappedNeighbor(const Board& board, Position p, Direction dir);
+
+// Direction of the shortest torus move from `from` towards `to`
+Direction directionTowards(const Board& board, Position from, Position to);
+
+// Number of steps along `dir` after which a ray from `from` first enters `to`
+// (following wrap-around), or -1 if the ray never does.
+int rayDistance(const Board& board, Position from, Position to, Direction dir);
+
+// Direction of the shortest wall-free firing ray from `from` to `to`,
+// or nothing if every ray that reaches `to` is blocked by a wall first.
+std::optional<Direction> lineOfSightDirection(const Board& board, Position from, Position to);
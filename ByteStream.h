@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Little-endian encoding used by the binary save formats (replays, snapshots)
+
+class ByteWriter {
+public:
+    void u8(std::uint8_t v) { bytes.push_back(v); }
+    void u16(std::uint16_t v) { u8((std::uint8_t)v); u8((std::uint8_t)(v >> 8)); }
+    void u32(std::uint32_t v) { u16((std::uint16_t)v); u16((std::uint16_t)(v >> 16)); }
+    void u64(std::uint64_t v) { u32((std::uint32_t)v); u32((std::uint32_t)(v >> 32)); }
+    void i32(int v) { u32((std::uint32_t)v); }
+    void str(const std::string& s) {
+        u32((std::uint32_t)s.size());
+        bytes.insert(bytes.end(), s.begin(), s.end());
+    }
+
+    std::vector<unsigned char>& data() { return bytes; }
+    const std::vector<unsigned char>& data() const { return bytes; }
+
+private:
+    std::vector<unsigned char> bytes;
+};
+
+// Reads what ByteWriter wrote; running past the end throws std::runtime_error
+class ByteReader {
+public:
+    explicit ByteReader(std::span<const unsigned char> bytes) : bytes(bytes) {}
+
+    std::uint8_t u8() { need(1); return bytes[pos++]; }
+    std::uint16_t u16() { std::uint16_t lo = u8(); return (std::uint16_t)(lo | u8() << 8); }
+    std::uint32_t u32() { std::uint32_t lo = u16(); return lo | (std::uint32_t)u16() << 16; }
+    std::uint64_t u64() { std::uint64_t lo = u32(); return lo | (std::uint64_t)u32() << 32; }
+    int i32() { return (int)u32(); }
+    std::string str() {
+        std::uint32_t size = u32();
+        need(size);
+        std::string s(reinterpret_cast<const char*>(bytes.data() + pos), size);
+        pos += size;
+        return s;
+    }
+    // The next `count` bytes, consumed without copying
+    std::span<const unsigned char> take(std::size_t count) {
+        need(count);
+        std::span<const unsigned char> out = bytes.subspan(pos, count);
+        pos += count;
+        return out;
+    }
+
+    std::size_t position() const { return pos; }
+    std::size_t remaining() const { return bytes.size() - pos; }
+
+private:
+    std::span<const unsigned char> bytes;
+    std::size_t pos = 0;
+
+    void need(std::size_t count) const {
+        if (count > bytes.size() - pos) throw std::runtime_error("Unexpected end of saved data.");
+    }
+};
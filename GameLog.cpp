@@ -0,0 +1,173 @@
+#include "GameLog.h"
+#include <cctype>
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+
+AsyncFileWriter& AsyncFileWriter::instance() {
+    static AsyncFileWriter writer;
+    return writer;
+}
+
+AsyncFileWriter::AsyncFileWriter() : worker([this] { run(); }) {}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AsyncFileWriter::submit(std::shared_ptr<std::ofstream> file, std::string&& buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({std::move(file), std::move(buffer)});
+    }
+    wake.notify_one();
+}
+
+std::string AsyncFileWriter::takeBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (spareBuffers.empty()) return {};
+    std::string buffer = std::move(spareBuffers.back());
+    spareBuffers.pop_back();
+    return buffer;
+}
+
+void AsyncFileWriter::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+void AsyncFileWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) break;   // stopping with nothing left to write
+
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+        lock.unlock();
+
+        job.file->write(job.buffer.data(), (std::streamsize)job.buffer.size());
+        job.file->flush();
+        if (!*job.file) std::cerr << "Error: failed to write game log\n";
+        job.buffer.clear();
+        job.file.reset();   // closes the file if its log is done with it
+
+        lock.lock();
+        writing = false;
+        spareBuffers.push_back(std::move(job.buffer));
+        if (queue.empty()) idle.notify_all();
+    }
+}
+
+GameLog::GameLog(const std::string& path, LogFormat format, std::vector<std::string> tankLabels)
+    : file(std::make_shared<std::ofstream>(path, std::ios::binary)), format(format), labels(std::move(tankLabels)) {
+    if (!file->is_open()) {
+        throw std::runtime_error("Failed to open output file: " + path);
+    }
+    for (const std::string& label : labels) {
+        std::string key = label;
+        for (char& c : key) c = (char)std::tolower((unsigned char)c);
+        jsonKeys.push_back(key);
+    }
+    buffer = AsyncFileWriter::instance().takeBuffer();
+    buffer.reserve(kFlushSize);
+}
+
+GameLog::~GameLog() {
+    close();
+}
+
+const char* GameLog::actionName(Action action) {
+    switch (action) {
+        case Action::MOVE_FORWARD: return "MOVE_FORWARD";
+        case Action::MOVE_BACKWARD: return "MOVE_BACKWARD";
+        case Action::ROTATE_LEFT_EIGHTH: return "ROTATE_LEFT_EIGHTH";
+        case Action::ROTATE_RIGHT_EIGHTH: return "ROTATE_RIGHT_EIGHTH";
+        case Action::ROTATE_LEFT_QUARTER: return "ROTATE_LEFT_QUARTER";
+        case Action::ROTATE_RIGHT_QUARTER: return "ROTATE_RIGHT_QUARTER";
+        case Action::SHOOT: return "SHOOT";
+        default: return "UNKNOWN_ACTION";
+    }
+}
+
+static void appendInt(std::string& out, int value) {
+    char digits[16];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, end);
+}
+
+// Result texts are plain ASCII, but keep the JSON valid whatever they hold
+static void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') out += '\\';
+        if ((unsigned char)ch < 0x20) ch = ' ';
+        out += ch;
+    }
+    out += '"';
+}
+
+void GameLog::step(int step, std::span<const Action> actions) {
+    if (!file) return;
+    if (format == LogFormat::TEXT) {
+        buffer += "STEP ";
+        appendInt(buffer, step);
+        buffer += ":\n";
+        for (size_t i = 0; i < actions.size(); ++i) {
+            buffer += labels[i];
+            buffer += " requested: ";
+            buffer += actionName(actions[i]);
+            buffer += '\n';
+        }
+    } else {
+        buffer += "{\"step\":";
+        appendInt(buffer, step);
+        for (size_t i = 0; i < actions.size(); ++i) {
+            buffer += ",\"";
+            buffer += jsonKeys[i];
+            buffer += "\":\"";
+            buffer += actionName(actions[i]);
+            buffer += '"';
+        }
+        buffer += "}\n";
+    }
+    if (buffer.size() >= kFlushSize) flush();
+}
+
+void GameLog::result(const std::string& result, int winner) {
+    if (!file) return;
+    if (format == LogFormat::TEXT) {
+        buffer += "Result: ";
+        buffer += result;
+        buffer += '\n';
+    } else {
+        buffer += "{\"result\":";
+        appendJsonString(buffer, result);
+        buffer += ",\"winner\":";
+        appendInt(buffer, winner);
+        buffer += "}\n";
+    }
+    if (buffer.size() >= kFlushSize) flush();
+}
+
+void GameLog::flush() {
+    AsyncFileWriter& writer = AsyncFileWriter::instance();
+    writer.submit(file, std::move(buffer));
+    buffer = writer.takeBuffer();
+    buffer.reserve(kFlushSize);
+}
+
+void GameLog::close() {
+    if (!file) return;
+    if (!buffer.empty()) {
+        AsyncFileWriter::instance().submit(file, std::move(buffer));
+        buffer = std::string();
+    }
+    file.reset();
+}
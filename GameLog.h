@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Tank.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class LogFormat {
+    TEXT,   // "STEP n:" blocks, as read by people and the course checker
+    JSONL   // one JSON object per line
+};
+
+// Single background thread that writes log buffers to their files, so games
+// never wait on I/O. Buffers for the same file are written in the order they
+// were submitted; written buffers are cleared and kept for reuse.
+class AsyncFileWriter {
+public:
+    static AsyncFileWriter& instance();
+    ~AsyncFileWriter();   // writes everything still queued
+
+    void submit(std::shared_ptr<std::ofstream> file, std::string&& buffer);
+    // An empty buffer with spare capacity, if one has been written already
+    std::string takeBuffer();
+    // Blocks until every submitted buffer has been written
+    void drain();
+
+private:
+    struct Job {
+        std::shared_ptr<std::ofstream> file;
+        std::string buffer;
+    };
+
+    AsyncFileWriter();
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Job> queue;
+    std::vector<std::string> spareBuffers;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;
+};
+
+// Per-game log sink. Records are formatted into a buffer that is handed to
+// the AsyncFileWriter once it fills up and when the log is closed.
+class GameLog {
+public:
+    GameLog() = default;   // discards every record
+    // `tankLabels` names the tanks in the order step() gets their actions
+    // ("P1", "P2", or "P1.2" for the second tank of player 1)
+    GameLog(const std::string& path, LogFormat format, std::vector<std::string> tankLabels);
+    ~GameLog();
+
+    void step(int step, std::span<const Action> actions);
+    void result(const std::string& result, int winner);
+    // Hands over what is buffered; the file is closed once it is written
+    void close();
+
+    static const char* actionName(Action action);
+
+private:
+    static constexpr std::size_t kFlushSize = 64 * 1024;
+
+    std::shared_ptr<std::ofstream> file;
+    LogFormat format = LogFormat::TEXT;
+    std::vector<std::string> labels;      // text format
+    std::vector<std::string> jsonKeys;    // the labels in lower case
+    std::string buffer;
+
+    void flush();
+};
@@ -1,6 +1,7 @@
 #include "GameState.h"
-#include <map>
-#include <set>
+#include "BoardGeometry.h"
+#include "ByteStream.h"
+#include <algorithm>
 #include <queue>
 #include <iostream>
 #include <fstream>
@@ -11,23 +12,94 @@
 #include <filesystem>
 
 using namespace std;
-int emptyAmmoSteps = 0;
-bool gameOver = false;
-std::string gameResult;
-GameState::GameState(Board& board, const std::string& inputFilename)
+// output_<input file name>, plus a .jsonl suffix for the JSONL log (appended
+// rather than replacing the extension, so a.txt and a.tnkb don't share a log)
+static std::string logPathFor(const std::string& inputFilename, LogFormat format) {
+    std::filesystem::path inputPath(inputFilename);
+    std::string outputName = "output_" + inputPath.filename().string();
+    if (format == LogFormat::JSONL) outputName += ".jsonl";
+    return (inputPath.parent_path() / outputName).string();
+}
+
+// Distinct players of a tank table sorted by player
+static std::vector<int> playersOf(const std::vector<Tank>& tanks) {
+    std::vector<int> players;
+    for (const Tank& tank : tanks) {
+        if (players.empty() || players.back() != tank.getPlayerId()) players.push_back(tank.getPlayerId());
+    }
+    return players;
+}
+
+GameState::GameState(Board& board, const std::string& inputFilename, LogFormat logFormat)
       : board(board),
-        tank1([&] { auto [x1, y1] = findTank(CellContent::TANK1); return Tank(1, x1, y1, Direction::L); }()),
-        tank2([&] { auto [x2, y2] = findTank(CellContent::TANK2); return Tank(2, x2, y2, Direction::R); }()) 
+        tanks(findTanks(board)),
+        players(playersOf(tanks)),
+        gameLog(logPathFor(inputFilename, logFormat), logFormat, tankLabels())
+  {
+  }
+
+GameState::GameState(Board& board)
+      : board(board),
+        tanks(findTanks(board)),
+        players(playersOf(tanks))
   {
-    std::filesystem::path inputPath(inputFilename);
-    std::string outputFilename = (inputPath.parent_path() / ("output_" + inputPath.filename().string())).string();
-    
-    
-      logFile.open(outputFilename);
-      if (!logFile.is_open()) {
-          throw std::runtime_error("Failed to open output file: " + outputFilename);
-      }
   }
+
+// Odd players start facing left and even players right, as players 1 and 2 always have
+std::vector<Tank> GameState::findTanks(const Board& board) {
+    std::vector<Tank> found;
+    for (int y = 0; y < board.getHeight(); ++y) {
+        for (const Cell& cell : board.row(y)) {
+            if (cell.content != CellContent::TANK) continue;
+            int x = (int)(&cell - board.row(y).data());
+            found.emplace_back(cell.tankPlayer, x, y, cell.tankPlayer % 2 == 1 ? Direction::L : Direction::R);
+        }
+    }
+    std::stable_sort(found.begin(), found.end(),
+                     [](const Tank& a, const Tank& b) { return a.getPlayerId() < b.getPlayerId(); });
+    return found;
+}
+
+std::string GameState::tankLabel(int tankIndex) const {
+    int player = tanks[tankIndex].getPlayerId();
+    int number = 0, count = 0;
+    for (int i = 0; i < (int)tanks.size(); ++i) {
+        if (tanks[i].getPlayerId() != player) continue;
+        ++count;
+        if (i <= tankIndex) ++number;
+    }
+    std::string label = "P";
+    label += std::to_string(player);
+    if (count > 1) {
+        label += '.';
+        label += std::to_string(number);
+    }
+    return label;
+}
+
+std::vector<std::string> GameState::tankLabels() const {
+    std::vector<std::string> labels;
+    for (int i = 0; i < (int)tanks.size(); ++i) labels.push_back(tankLabel(i));
+    return labels;
+}
+
+int GameState::nearestEnemy(int tankIndex) const {
+    const Tank& self = tanks[tankIndex];
+    auto [x, y] = self.getPosition();
+    int best = -1, bestDistance = 0;
+    for (int i = 0; i < (int)tanks.size(); ++i) {
+        const Tank& other = tanks[i];
+        if (!other.isAlive() || other.getPlayerId() == self.getPlayerId()) continue;
+        auto [ox, oy] = other.getPosition();
+        int distance = std::max(std::abs(wrappedDelta(x, ox, board.getWidth())),
+                                std::abs(wrappedDelta(y, oy, board.getHeight())));
+        if (best < 0 || distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
   
 
 
@@ -64,240 +136,428 @@ void GameState::applyAction(Tank& tank, Action action) {
 }
 
 bool GameState::step(Action p1Action, Action p2Action) {
+    if (tanks.size() != 2) {
+        throw std::invalid_argument("step(p1, p2) needs a game of two tanks");
+    }
+    const Action actions[2] = {p1Action, p2Action};
+    return step(actions);
+}
+
+bool GameState::step(std::span<const Action> actions) {
     if (gameOver) return true;
-    applyTankActions(p1Action, p2Action);
-
-    handleTankMineCollisions();
-    updateTankCooldowns();
-    confirmBackwardMoves();
-    updateTankPositionsOnBoard();
-    updateShellsWithOverrunCheck();
-    resolveShellCollisions();
-    filterRemainingShells();
-    handleTankShooting(p1Action, p2Action);
-    checkGameEndConditions(p1Action, p2Action);
+    if (actions.size() != tanks.size()) {
+        throw std::invalid_argument("Expected one action per tank");
+    }
+    threatsStale = true;
+    // Tanks destroyed during this step still complete it (a tank hit by a
+    // shell fires the shot it asked for); those destroyed earlier sit it out
+    actsThisStep.resize(tanks.size());
+    for (size_t i = 0; i < tanks.size(); ++i) actsThisStep[i] = tanks[i].isAlive();
+
+    { ProfileScope scope(profiler, StepPhase::APPLY_ACTIONS); applyTankActions(actions); }
+
+    { ProfileScope scope(profiler, StepPhase::MINES); handleTankMineCollisions(); }
+    { ProfileScope scope(profiler, StepPhase::COOLDOWNS); updateTankCooldowns(); }
+    { ProfileScope scope(profiler, StepPhase::BACKWARD_MOVES); confirmBackwardMoves(); }
+    { ProfileScope scope(profiler, StepPhase::TANK_MARKS); updateTankPositionsOnBoard(); }
+    { ProfileScope scope(profiler, StepPhase::SHELL_MOVES); updateShellsWithOverrunCheck(); }
+    { ProfileScope scope(profiler, StepPhase::SHELL_COLLISIONS); resolveShellCollisions(); }
+    { ProfileScope scope(profiler, StepPhase::SHELL_CLEANUP); filterRemainingShells(); }
+    { ProfileScope scope(profiler, StepPhase::SHOOTING); handleTankShooting(actions); }
+    { ProfileScope scope(profiler, StepPhase::END_CONDITIONS); checkGameEndConditions(actions); }
 
     return gameOver;
 }
 
 void GameState::handleTankMineCollisions() {
-    auto [x1, y1] = tank1.getPosition();
-    auto [x2, y2] = tank2.getPosition();
-    if (tank1.isAlive() && board.getCell(x1, y1).content == CellContent::MINE) {
-        tank1.destroy();
-        board.setCell(x1, y1, CellContent::EMPTY);
-    }
-    if (tank2.isAlive() && board.getCell(x2, y2).content == CellContent::MINE) {
-        tank2.destroy();
-        board.setCell(x2, y2, CellContent::EMPTY);
+    for (Tank& tank : tanks) {
+        if (!tank.isAlive()) continue;
+        auto [x, y] = tank.getPosition();
+        auto cell = board.cell(x, y);
+        if (cell.content() == CellContent::MINE) {
+            tank.destroy();
+            cell.setContent(CellContent::EMPTY);
+        }
     }
 }
 
 void GameState::updateTankCooldowns() {
-    tank1.updateCooldowns();
-    tank2.updateCooldowns();
+    for (Tank& tank : tanks) tank.updateCooldowns();
 }
 
-void GameState::applyTankActions(Action p1Action, Action p2Action) {
-    applyAction(tank1, p1Action);
-    applyAction(tank2, p2Action);
+void GameState::applyTankActions(std::span<const Action> actions) {
+    for (size_t i = 0; i < tanks.size(); ++i) {
+        if (actsThisStep[i]) applyAction(tanks[i], actions[i]);
+    }
+    wrapTankPositions();
 }
 
 void GameState::confirmBackwardMoves() {
-    tank1.confirmBackwardMove();
-    tank2.confirmBackwardMove();
+    for (Tank& tank : tanks) tank.confirmBackwardMove();
+    wrapTankPositions();
+}
+
+// Tanks that drive off an edge re-enter on the opposite side, like shells
+void GameState::wrapTankPositions() {
+    for (Tank& tank : tanks) {
+        auto [x, y] = tank.getPosition();
+        board.wrapCoords(x, y);
+        tank.setPosition(x, y);
+    }
+}
+
+// Starts a new round of cell counts in cellVisits
+void GameState::nextVisitStamp() {
+    if (cellVisits.size() != (size_t)board.getCellCount()) {
+        cellVisits.assign(board.getCellCount(), CellVisits{});
+        visitStamp = 0;
+    }
+    if (++visitStamp == 0) {
+        // Stamp wrapped around: old stamps could look current again
+        std::fill(cellVisits.begin(), cellVisits.end(), CellVisits{});
+        visitStamp = 1;
+    }
 }
 
+// Living tanks that end up in the same cell destroy each other. Tanks are
+// counted per cell, so this costs one pass over the tanks however many share.
 void GameState::updateTankPositionsOnBoard() {
     board.clearTankMarks();
-    auto [x1, y1] = tank1.getPosition();
-    auto [x2, y2] = tank2.getPosition();
-
-    if (tank1.isAlive() && tank2.isAlive() &&
-    tank1.getPosition() == tank2.getPosition()) {
-    tank1.destroy();
-    tank2.destroy();
-    board.setCell(x1, y1, CellContent::EMPTY);
+    nextVisitStamp();
+    for (const Tank& tank : tanks) {
+        if (!tank.isAlive()) continue;
+        CellVisits& visits = cellVisits[board.index(tank.getPosition().first, tank.getPosition().second)];
+        if (visits.stamp != visitStamp) {
+            visits.stamp = visitStamp;
+            visits.count = 0;
+        }
+        visits.count++;
+    }
+    for (Tank& tank : tanks) {
+        if (!tank.isAlive()) continue;
+        auto [x, y] = tank.getPosition();
+        if (cellVisits[board.index(x, y)].count > 1) {
+            tank.destroy();
+            board.setCell(x, y, CellContent::EMPTY);
+        }
     }
 
+    for (const Tank& tank : tanks) {
+        if (tank.isAlive()) board.setTank(tank.getPosition().first, tank.getPosition().second, tank.getPlayerId());
+    }
+}
 
-    if (tank1.isAlive()) board.setCell(x1, y1, CellContent::TANK1);
-    if (tank2.isAlive()) board.setCell(x2, y2, CellContent::TANK2);
+void GameState::setStepThreads(int threads, size_t minShells) {
+    if (threads > 1) stepPool = std::make_unique<WorkerPool>(threads);
+    else stepPool.reset();
+    striped.minShells = minShells;
 }
 
 void GameState::updateShellsWithOverrunCheck() {
     board.clearShellMarks();
-    toRemove.clear();
-    positionMap.clear();
+    shellVisits.clear();
+    nextVisitStamp();
 
-    for (size_t i = 0; i < shells.size(); ++i) {
-        int dx = 0, dy = 0;
-        switch (shells[i].dir) {
-            case Direction::U:  dy = -1; break;
-            case Direction::UR: dx = 1; dy = -1; break;
-            case Direction::R:  dx = 1; break;
-            case Direction::DR: dx = 1; dy = 1; break;
-            case Direction::D:  dy = 1; break;
-            case Direction::DL: dx = -1; dy = 1; break;
-            case Direction::L:  dx = -1; break;
-            case Direction::UL: dx = -1; dy = -1; break;
-        }
+    stripedShells = stepPool && shells.size() >= striped.minShells;
+    if (stripedShells) {
+        moveShellsStriped();
+        return;
+    }
 
-        for (int step = 0; step < 2; ++step) { // move twice per turn
-            int nextX = shells[i].x + dx;
-            int nextY = shells[i].y + dy;
-
-            bool wrapped = false;
-
-            if (nextX < 0 || nextX >= board.getWidth() || nextY < 0 || nextY >= board.getHeight()) {
-                int wrapX = (nextX + board.getWidth()) % board.getWidth();
-                int wrapY = (nextY + board.getHeight()) % board.getHeight();
-                auto borderCell = board.getCell(wrapX, wrapY);
-
-                if (borderCell.content == CellContent::WALL) {
-                    // Hit border wall: Damage it and destroy shell
-                    board.grid[wrapY][wrapX].wallHits++;
-                    if (board.grid[wrapY][wrapX].wallHits >= 2) {
-                        board.setCell(wrapX, wrapY, CellContent::EMPTY);
-                    }
-                    toRemove.insert(i);
-                    break; // shell destroyed
-                } else {
-                    // Wall already broken -> allow wrapping
-                    nextX = wrapX;
-                    nextY = wrapY;
-                    wrapped = true;
-                }
-            }
+    // Positions don't depend on what the shells hit, so they are computed for
+    // all shells at once; the hits are then applied shell by shell in order.
+    shells.advance(board.getWidth(), board.getHeight());
 
-            shells[i].x = nextX;
-            shells[i].y = nextY;
+    for (size_t i = 0; i < shells.size(); ++i) moveShell(i, nullptr);
+}
 
-            if (handleShellMidStepCollision(shells[i].x, shells[i].y)) {
-                toRemove.insert(i);
-                break; // shell destroyed
+// Both sub-steps of an advanced shell, applying what it hits. Cells it passes
+// through are recorded with recordShellVisit, or with `visits` stored in
+// visits[0] and visits[1] (left alone for sub-steps without a visit).
+void GameState::moveShell(size_t i, int* visits) {
+    for (int step = 0; step < 2; ++step) { // move twice per turn
+        int x = step == 0 ? shells.midX(i) : shells.x(i);
+        int y = step == 0 ? shells.midY(i) : shells.y(i);
+        bool wrapped = (shells.crossedEdges(i) >> step) & 1;
+
+        if (wrapped) {
+            auto borderCell = board.cell(x, y);
+            if (borderCell.content() == CellContent::WALL) {
+                // Hit border wall: Damage it and destroy shell
+                borderCell.damageWall();
+                shells.kill(i);
+                return; // shell destroyed
             }
+            // Wall already broken -> allow wrapping
+        }
+
+        if (handleShellMidStepCollision(x, y)) {
+            shells.kill(i);
+            return; // shell destroyed
+        }
+
+        if (!wrapped) {
+            if (visits) visits[step] = board.index(x, y);
+            else recordShellVisit(board.index(x, y), i);
+        }
+    }
+}
+
+int GameState::stripeOf(int cellIndex) const {
+    return (int)((long long)(cellIndex / board.getWidth()) * striped.stripes / board.getHeight());
+}
 
-            if (!wrapped) {
-                positionMap[{shells[i].x, shells[i].y}].push_back(i);
+// The serial loop, split by what can change under a shell. Cells only ever
+// lose walls and tanks during the shell phases, so a shell whose two cells
+// hold neither when the phase starts passes through whatever the shells
+// before it did, and its visits can be found in parallel. The few shells
+// that meet a wall or a tank are played one at a time in shell order, exactly
+// as serially, and they are the only ones that write to the board.
+void GameState::moveShellsStriped() {
+    const Board& view = board;   // the workers only read it
+    int width = view.getWidth(), height = view.getHeight();
+    size_t count = shells.size();
+    striped.chunks = stepPool->getThreadCount();
+    striped.stripes = std::min(height, 4 * striped.chunks);
+    int chunks = striped.chunks, stripes = striped.stripes;
+    striped.visitCells.assign(2 * count, -1);
+    striped.hardShells.resize(chunks);
+    striped.loneHits.resize(chunks);
+    striped.bins.resize((size_t)(chunks + 1) * stripes);
+    striped.newlyMarked.resize(stripes);
+    for (auto& bin : striped.bins) bin.clear();
+
+    shells.beginAdvance();
+    stepPool->run(chunks, [&](int c) {
+        size_t begin = count * c / chunks, end = count * (c + 1) / chunks;
+        shells.advanceRange(width, height, begin, end);
+        std::vector<size_t>& hard = striped.hardShells[c];
+        hard.clear();
+        for (size_t i = begin; i < end; ++i) {
+            int cells[2] = {view.index(shells.midX(i), shells.midY(i)), view.index(shells.x(i), shells.y(i))};
+            CellContent first = view.cells()[cells[0]].content, second = view.cells()[cells[1]].content;
+            if (first == CellContent::WALL || first == CellContent::TANK ||
+                second == CellContent::WALL || second == CellContent::TANK) {
+                hard.push_back(i);
+                continue;
+            }
+            for (int step = 0; step < 2; ++step) {
+                if ((shells.crossedEdges(i) >> step) & 1) continue;
+                striped.visitCells[2 * i + step] = cells[step];
+                striped.bins[(size_t)c * stripes + stripeOf(cells[step])].push_back(cells[step]);
+            }
+        }
+    });
+
+    for (const auto& hard : striped.hardShells) {
+        for (size_t i : hard) {
+            moveShell(i, &striped.visitCells[2 * i]);
+            for (int step = 0; step < 2; ++step) {
+                int cell = striped.visitCells[2 * i + step];
+                if (cell >= 0) striped.bins[(size_t)chunks * stripes + stripeOf(cell)].push_back(cell);
             }
         }
     }
+
+    // Visit counts, each stripe counting its own cells
+    stepPool->run(stripes, [&](int s) {
+        for (int c = 0; c <= chunks; ++c) {
+            for (int cell : striped.bins[(size_t)c * stripes + s]) {
+                CellVisits& visits = cellVisits[cell];
+                if (visits.stamp != visitStamp) {
+                    visits.stamp = visitStamp;
+                    visits.count = 0;
+                }
+                visits.count++;
+            }
+        }
+    });
 }
 
 bool GameState::handleShellMidStepCollision(int x, int y) {
-    auto cell = board.getCell(x, y);
+    auto cell = board.cell(x, y);
+    CellContent content = cell.content();
 
-    if (cell.content == CellContent::WALL) {
-        board.grid[y][x].wallHits++;
-        if (board.grid[y][x].wallHits >= 2) {
-            board.setCell(x, y, CellContent::EMPTY);
-        }
+    if (content == CellContent::WALL) {
+        cell.damageWall();
         return true; // Shell is destroyed upon hitting a wall
     }
 
-    if (cell.content == CellContent::TANK1 && tank1.isAlive()) {
-        tank1.destroy();
-        board.setCell(x, y, CellContent::EMPTY);
-        return true;
+    if (content == CellContent::TANK) {
+        int tank = aliveTankAt(x, y);
+        if (tank >= 0) {
+            destroyTank(tank, cell);
+            return true;
+        }
     }
 
-    if (cell.content == CellContent::TANK2 && tank2.isAlive()) {
-        tank2.destroy();
-        board.setCell(x, y, CellContent::EMPTY);
-        return true;
+    return false;
+}
+
+// Index of the living tank in (x, y), or -1. Only asked when a shell meets a
+// tank mark, which then destroys the tank, so it runs about once per tank.
+int GameState::aliveTankAt(int x, int y) const {
+    for (int i = 0; i < (int)tanks.size(); ++i) {
+        if (tanks[i].isAlive() && tanks[i].getPosition() == std::make_pair(x, y)) return i;
     }
+    return -1;
+}
 
-    return false;
+void GameState::destroyTank(int tankIndex, CellHandle cell) {
+    tanks[tankIndex].destroy();
+    cell.setContent(CellContent::EMPTY);
 }
 
 
 
 
-void GameState::resolveShellCollisions() {
-    for (const auto& [pos, indices] : positionMap) {
-        int x = pos.first, y = pos.second;
-        auto cell = board.getCell(x, y);
+void GameState::recordShellVisit(int cellIndex, size_t shellIndex) {
+    CellVisits& visits = cellVisits[cellIndex];
+    if (visits.stamp != visitStamp) {
+        visits.stamp = visitStamp;
+        visits.count = 0;
+    }
+    visits.count++;
+    shellVisits.push_back({cellIndex, shellIndex});
+}
 
-        if (indices.size() > 1) {
-            for (size_t i : indices) toRemove.insert(i);
+// Every cell visited this step is resolved once: shells sharing a cell
+// destroy each other, a lone shell hits whatever the cell holds.
+void GameState::resolveShellCollisions() {
+    if (stripedShells) {
+        resolveShellCollisionsStriped();
+        return;
+    }
+    for (const auto& [cellIndex, i] : shellVisits) {
+        if (cellVisits[cellIndex].count > 1) {
+            shells.kill(i);
             continue;
         }
+        hitLoneShell(cellIndex, i);
+    }
+}
 
-        size_t i = indices[0];
-        if (cell.content == CellContent::WALL) {
-            board.grid[y][x].wallHits++;
-            if (board.grid[y][x].wallHits >= 2)
-                board.setCell(x, y, CellContent::EMPTY);
-            toRemove.insert(i);
-        } else if (cell.content == CellContent::TANK1 && tank1.isAlive()) {
-            tank1.destroy();
-            board.setCell(x, y, CellContent::EMPTY);
-            toRemove.insert(i);
-        } else if (cell.content == CellContent::TANK2 && tank2.isAlive()) {
-            tank2.destroy();
-            board.setCell(x, y, CellContent::EMPTY);
-            toRemove.insert(i);
+void GameState::hitLoneShell(int cellIndex, size_t i) {
+    auto cell = board.cell(cellIndex);
+    CellContent content = cell.content();
+    if (content == CellContent::WALL) {
+        cell.damageWall();
+        shells.kill(i);
+    } else if (content == CellContent::TANK) {
+        int tank = aliveTankAt(cellIndex % board.getWidth(), cellIndex / board.getWidth());
+        if (tank >= 0) {
+            destroyTank(tank, cell);
+            shells.kill(i);
         }
     }
 }
 
+// Each chunk kills its own shells; lone shells on a wall or a tank change the
+// board, so they are collected and hit in the serial loop's order
+void GameState::resolveShellCollisionsStriped() {
+    const Board& view = board;
+    size_t count = shells.size();
+    int chunks = striped.chunks;
+    stepPool->run(chunks, [&](int c) {
+        auto& lone = striped.loneHits[c];
+        lone.clear();
+        for (size_t i = count * c / chunks; i < count * (c + 1) / chunks; ++i) {
+            for (int step = 0; step < 2; ++step) {
+                int cell = striped.visitCells[2 * i + step];
+                if (cell < 0) continue;
+                if (cellVisits[cell].count > 1) {
+                    shells.kill(i);
+                    continue;
+                }
+                CellContent content = view.cells()[cell].content;
+                if (content == CellContent::WALL || content == CellContent::TANK) lone.push_back({cell, i});
+            }
+        }
+    });
+    for (const auto& lone : striped.loneHits) {
+        for (const auto& [cell, i] : lone) hitLoneShell(cell, i);
+    }
+}
+
+// Overlays of the surviving shells, binned by stripe like the visits
+void GameState::markShellsStriped() {
+    const Board& view = board;
+    size_t count = shells.size();
+    int chunks = striped.chunks, stripes = striped.stripes;
+    for (auto& bin : striped.bins) bin.clear();
+    stepPool->run(chunks, [&](int c) {
+        for (size_t i = count * c / chunks; i < count * (c + 1) / chunks; ++i) {
+            if (!shells.isAlive(i)) continue;
+            int cell = view.index(shells.x(i), shells.y(i));
+            striped.bins[(size_t)c * stripes + stripeOf(cell)].push_back(cell);
+        }
+    });
+    stepPool->run(stripes, [&](int s) {
+        striped.newlyMarked[s].clear();
+        for (int c = 0; c < chunks; ++c) board.markShellCells(striped.bins[(size_t)c * stripes + s], striped.newlyMarked[s]);
+    });
+    for (const auto& marked : striped.newlyMarked) board.commitShellMarks(marked);
+}
+
 void GameState::filterRemainingShells() {
-    std::vector<Shell> remaining;
+    if (stripedShells) {
+        markShellsStriped();
+        shells.compact();
+        return;
+    }
     for (size_t i = 0; i < shells.size(); ++i) {
-        if (toRemove.find(i) == toRemove.end()) {
-            remaining.push_back(shells[i]);
-            board.grid[shells[i].y][shells[i].x].hasShellOverlay = true;
+        if (shells.isAlive(i)) {
+            board.cell(shells.x(i), shells.y(i)).setShellOverlay(true);
         }
     }
-    shells = std::move(remaining);
+    shells.compact();
 }
-void GameState::handleTankShooting(Action p1Action, Action p2Action) {
+void GameState::handleTankShooting(std::span<const Action> actions) {
     auto spawnShell = [&](Tank& tank) {
-        auto [sx, sy] = tank.getPosition();
-        int dx = 0, dy = 0;
-        switch (tank.getDirection()) {
-            case Direction::U:  dy = -1; break;
-            case Direction::UR: dx = 1; dy = -1; break;
-            case Direction::R:  dx = 1; break;
-            case Direction::DR: dx = 1; dy = 1; break;
-            case Direction::D:  dy = 1; break;
-            case Direction::DL: dx = -1; dy = 1; break;
-            case Direction::L:  dx = -1; break;
-            case Direction::UL: dx = -1; dy = -1; break;
-        }
-
-        int spawnX = (sx + dx + board.getWidth()) % board.getWidth();
-        int spawnY = (sy + dy + board.getHeight()) % board.getHeight();
+        auto [spawnX, spawnY] = wrappedNeighbor(board, tank.getPosition(), tank.getDirection());
 
         // Immediate collision check upon spawning
         if (!handleShellMidStepCollision(spawnX, spawnY)) {
-            shells.push_back({spawnX, spawnY, tank.getDirection()});
+            shells.push(spawnX, spawnY, tank.getDirection());
         }
     };
 
-    if (p1Action == Action::SHOOT && tank1.canShoot()) {
-        tank1.shoot();
-        spawnShell(tank1);
-    }
-    if (p2Action == Action::SHOOT && tank2.canShoot()) {
-        tank2.shoot();
-        spawnShell(tank2);
+    for (size_t i = 0; i < tanks.size(); ++i) {
+        if (actsThisStep[i] && actions[i] == Action::SHOOT && tanks[i].canShoot()) {
+            tanks[i].shoot();
+            spawnShell(tanks[i]);
+        }
     }
 }
 
 
-void GameState::checkGameEndConditions(Action p1Action, Action p2Action) {
-    if (!tank1.isAlive() && tank2.isAlive()) {
-        gameOver = true;
-        gameResult = "Player 2 wins (Player 1 destroyed)";
-    } else if (!tank2.isAlive() && tank1.isAlive()) {
+void GameState::checkGameEndConditions(std::span<const Action> actions) {
+    int playersAlive = 0, lastAlive = 0, lastDead = 0;
+    bool shellsLeft = false;
+    for (int player : players) {
+        bool alive = false;
+        for (const Tank& tank : tanks) {
+            if (tank.getPlayerId() != player || !tank.isAlive()) continue;
+            alive = true;
+            shellsLeft = shellsLeft || tank.getShellCount() > 0;
+        }
+        if (alive) {
+            playersAlive++;
+            lastAlive = player;
+        } else {
+            lastDead = player;
+        }
+    }
+
+    if (playersAlive == 1 && players.size() > 1) {
         gameOver = true;
-        gameResult = "Player 1 wins (Player 2 destroyed)";
-    } else if (!tank1.isAlive() && !tank2.isAlive()) {
+        gameResult = "Player " + std::to_string(lastAlive) + " wins (" +
+                     (players.size() == 2 ? "Player " + std::to_string(lastDead) : std::string("all other players")) +
+                     " destroyed)";
+    } else if (playersAlive == 0) {
         gameOver = true;
-        gameResult = "Tie (Both tanks destroyed)";
-    } else if (tank1.getShellCount() == 0 && tank2.getShellCount() == 0) {
+        gameResult = tanks.size() == 2 ? "Tie (Both tanks destroyed)" : "Tie (All tanks destroyed)";
+    } else if (!shellsLeft) {
         emptyAmmoSteps++;
         if (emptyAmmoSteps >= 40) {
             gameOver = true;
@@ -307,61 +567,173 @@ void GameState::checkGameEndConditions(Action p1Action, Action p2Action) {
         emptyAmmoSteps = 0;
     }
 
+    gameLog.step(stepCounter++, actions);
     if (gameOver) {
-        logFile << "Result: " << gameResult << "\n";
-        logFile.close();
+        gameLog.result(gameResult, getWinner());
+        gameLog.close();
     }
-    logFile << "STEP " << stepCounter++ << ":\n";
-    logFile << "P1 requested: " << actionToString(p1Action) << "\n";
-    logFile << "P2 requested: " << actionToString(p2Action) << "\n";
 }
 
-std::string GameState::actionToString(Action a) const{
-    switch (a) {
-        case Action::MOVE_FORWARD: return "MOVE_FORWARD";
-        case Action::MOVE_BACKWARD: return "MOVE_BACKWARD";
-        case Action::ROTATE_LEFT_EIGHTH: return "ROTATE_LEFT_EIGHTH";
-        case Action::ROTATE_RIGHT_EIGHTH: return "ROTATE_RIGHT_EIGHTH";
-        case Action::ROTATE_LEFT_QUARTER: return "ROTATE_LEFT_QUARTER";
-        case Action::ROTATE_RIGHT_QUARTER: return "ROTATE_RIGHT_QUARTER";
-        case Action::SHOOT: return "SHOOT";
-        default: return "UNKNOWN_ACTION";
-    }
+GameState::Snapshot GameState::snapshot() const {
+    Snapshot snap;
+    snapshot(snap);
+    return snap;
 }
 
+void GameState::snapshot(Snapshot& into) const {
+    into.cells.assign(board.cells().begin(), board.cells().end());
+    into.tanks = tanks;
+    into.shells.copyShellsFrom(shells);
+    into.stepCounter = stepCounter;
+    into.emptyAmmoSteps = emptyAmmoSteps;
+    into.gameOver = gameOver;
+    into.gameResult = gameResult;
+}
 
+void GameState::restore(const Snapshot& snap) {
+    board.restoreCells(snap.cells);
+    tanks = snap.tanks;
+    players = playersOf(tanks);
+    shells.copyShellsFrom(snap.shells);
+    stepCounter = snap.stepCounter;
+    emptyAmmoSteps = snap.emptyAmmoSteps;
+    gameOver = snap.gameOver;
+    gameResult = snap.gameResult;
+    threatsStale = true;
+}
 
+GameState::Checkpoint GameState::checkpoint() {
+    if (checkpointCount == checkpoints.size()) checkpoints.emplace_back();
+    CheckpointFrame& frame = checkpoints[checkpointCount];
+    board.setJournaling(true);
+    frame.journalSize = board.journalSize();
+    frame.tanks = tanks;
+    frame.shells.copyShellsFrom(shells);
+    frame.stepCounter = stepCounter;
+    frame.emptyAmmoSteps = emptyAmmoSteps;
+    frame.gameOver = gameOver;
+    return checkpointCount++;
+}
 
+void GameState::rollback(Checkpoint checkpoint) {
+    if (checkpoint >= checkpointCount) {
+        throw std::logic_error("Rolling back a checkpoint that is no longer open");
+    }
+    const CheckpointFrame& frame = checkpoints[checkpoint];
+    board.rollbackJournal(frame.journalSize);
+    tanks = frame.tanks;
+    shells.copyShellsFrom(frame.shells);
+    stepCounter = frame.stepCounter;
+    emptyAmmoSteps = frame.emptyAmmoSteps;
+    if (!frame.gameOver) gameResult.clear();   // the result is only set when the game ends
+    gameOver = frame.gameOver;
+    threatsStale = true;
+    release(checkpoint);
+}
 
-std::pair<int, int> GameState::findTank(CellContent tankSymbol) {
-    for (int y = 0; y < board.getHeight(); ++y) {
-        for (int x = 0; x < board.getWidth(); ++x) {
-            if (board.getCell(x, y).content == tankSymbol) {
-                return {x, y};
-            }
-        }
+void GameState::release(Checkpoint checkpoint) {
+    if (checkpoint >= checkpointCount) {
+        throw std::logic_error("Releasing a checkpoint that is no longer open");
     }
-    return {-1, -1}; // Not found
+    checkpointCount = checkpoint;
+    if (checkpointCount == 0) board.setJournaling(false);
 }
-std::pair<int, int> GameState::getTank1Position() const {
-    return tank1.getPosition();
+
+void GameState::serialize(ByteWriter& out) const {
+    out.u32((std::uint32_t)tanks.size());
+    for (const Tank& tank : tanks) tank.serialize(out);
+    shells.serialize(out);
+    out.i32(stepCounter);
+    out.i32(emptyAmmoSteps);
+    out.u8(gameOver);
+    out.str(gameResult);
 }
-std::pair<int, int> GameState::getTank2Position() const {
-    return tank2.getPosition();
+
+void GameState::restore(ByteReader& in) {
+    // Positions and players are checked against this board before anything
+    // is replaced, so bad data can't index outside the grid later
+    auto onBoard = [&](int x, int y) {
+        return x >= 0 && x < board.getWidth() && y >= 0 && y < board.getHeight();
+    };
+    std::uint32_t tankCount = in.u32();
+    std::vector<Tank> loaded;
+    for (std::uint32_t i = 0; i < tankCount; ++i) {
+        Tank tank = Tank::deserialize(in);
+        if (tank.getPlayerId() < 1 || tank.getPlayerId() > Board::kMaxPlayers) {
+            throw std::runtime_error("Invalid tank player in saved data.");
+        }
+        if (!onBoard(tank.getPosition().first, tank.getPosition().second)) {
+            throw std::runtime_error("Invalid tank position in saved data.");
+        }
+        loaded.push_back(tank);
+    }
+    ShellPool loadedShells = ShellPool::deserialize(in);
+    for (std::size_t i = 0; i < loadedShells.size(); ++i) {
+        if (!onBoard(loadedShells.x(i), loadedShells.y(i))) {
+            throw std::runtime_error("Invalid shell position in saved data.");
+        }
+    }
+    int loadedSteps = in.i32();
+    int loadedEmptyAmmoSteps = in.i32();
+    bool loadedGameOver = in.u8() != 0;
+    std::string loadedResult = in.str();
+    tanks = std::move(loaded);
+    players = playersOf(tanks);
+    shells = std::move(loadedShells);
+    stepCounter = loadedSteps;
+    emptyAmmoSteps = loadedEmptyAmmoSteps;
+    gameOver = loadedGameOver;
+    gameResult = std::move(loadedResult);
+    threatsStale = true;
 }
 
+std::string GameState::actionToString(Action a) const{
+    return GameLog::actionName(a);
+}
+
+
+
+
+
+
 std::string GameState::render() const {
     if (gameOver) {
-        return board.print(tank1.getDirection(), tank2.getDirection()) + "GAME OVER: " + gameResult + "\n";
+        return board.print(tanks) + "GAME OVER: " + gameResult + "\n";
     }else{
-        return  board.print(tank1.getDirection(), tank2.getDirection()) + "\n";
+        return  board.print(tanks) + "\n";
     }
 }
 
+const ShellPool& GameState::getShells() const {
+    return shells;
+}
+const ThreatMap& GameState::getThreats() const {
+    if (threatsStale) {
+        threats.build(board, shells);
+        threatsStale = false;
+    }
+    return threats;
+}
+
 std::string GameState::getResult() const {
     return gameOver ? gameResult : "";
 }
 
+int GameState::getWinner() const {
+    if (!gameOver || players.size() < 2) return 0;
+    int winner = 0;
+    for (const Tank& tank : tanks) {
+        if (!tank.isAlive()) continue;
+        if (winner != 0 && winner != tank.getPlayerId()) return 0;
+        winner = tank.getPlayerId();
+    }
+    return winner;
+}
+
+int GameState::getStepCount() const {
+    return stepCounter;
+}
+
 bool GameState::isGameOver() const {
     return gameOver;
 }
\ No newline at end of file
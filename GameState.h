@@ -2,60 +2,187 @@
 
 #include "Board.h"
 #include "Tank.h"
-#include <set>
-#include <map>
+#include "ShellPool.h"
+#include "ThreatMap.h"
+#include "GameLog.h"
+#include "StepProfiler.h"
+#include "WorkerPool.h"
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <vector>
 #include <utility>
-#include <fstream> 
 
 
 
 using namespace std;
-struct Shell {
-    int x, y;
-    Direction dir;
-};
 
 class GameState {
     friend int main(int argc, char* argv[]); 
     public:
-    GameState(Board& board, const std::string& inputFilename); 
+    GameState(Board& board, const std::string& inputFilename, LogFormat logFormat = LogFormat::TEXT);
+    // Plays on `board` without writing a log (replays, search)
+    explicit GameState(Board& board);
 
+    // One action per tank, in tank table order. Tanks destroyed in an earlier
+    // step ignore theirs.
+    bool step(std::span<const Action> actions);
+    // The same for a game of exactly two tanks
     bool step(Action p1Action, Action p2Action);
     std::string render() const;
 
+    // The tank table: every tank on the board, grouped by player (in player
+    // order) and within a player in row-major order of the starting cells.
+    // Indices into it are stable for the whole game.
+    const std::vector<Tank>& getTanks() const { return tanks; }
+    int getTankCount() const { return (int)tanks.size(); }
+    const Tank& getTank(int index) const { return tanks[index]; }
+    // Players that had tanks at the start, ascending
+    const std::vector<int>& getPlayers() const { return players; }
+    // Closest living tank of another player (wrap-around Chebyshev distance,
+    // lowest index on ties), or -1 if there is none
+    int nearestEnemy(int tankIndex) const;
+    // Label of a tank in logs and views: "P<player>", or "P<player>.<n>" for
+    // the n-th tank of a player that has several
+    std::string tankLabel(int tankIndex) const;
 
-    std::pair<int, int> getTank1Position() const;
-    std::pair<int, int> getTank2Position() const;
+    const ShellPool& getShells() const;
+    // Shell arrival turns for the current position, built on first use per step
+    const ThreatMap& getThreats() const;
+    const Board& getBoard() const { return board; }
     std::string getResult() const;
+    int getWinner() const; // player left standing; 0 while running or on a tie
+    int getStepCount() const;
     bool isGameOver() const;
+    // Phase timings of this game (empty unless built with TANK_PROFILE); the
+    // game loop adds the algorithms' decision times with ProfileScope
+    StepProfiler& getProfiler() { return profiler; }
+    const StepProfiler& getProfiler() const { return profiler; }
+
+    // Runs the shell phases of step() on `threads` threads (1, the default,
+    // runs everything on the calling thread), over horizontal stripes of the
+    // board. Only steps with at least `minShells` shells in flight are split.
+    // The game plays out bit for bit as it does serially.
+    void setStepThreads(int threads, size_t minShells = kMinStripedShells);
+    int getStepThreads() const { return stepPool ? stepPool->getThreadCount() : 1; }
+    static constexpr size_t kMinStripedShells = 4096;
 
 
     void handleTankMineCollisions();
     void updateTankCooldowns();
-    void applyTankActions(Action p1Action, Action p2Action);
+    void applyTankActions(std::span<const Action> actions);
     void confirmBackwardMoves();
     void updateTankPositionsOnBoard();
     void updateShellsWithOverrunCheck();
     void resolveShellCollisions();
     void filterRemainingShells();
-    void handleTankShooting(Action p1Action, Action p2Action);
-    void checkGameEndConditions(Action p1Action, Action p2Action);
+    void handleTankShooting(std::span<const Action> actions);
+    void checkGameEndConditions(std::span<const Action> actions);
     bool handleShellMidStepCollision(int x, int y);
 
     std::string actionToString(Action a) const;
 
+    // Value copy of everything step() depends on, board cells included. Restore
+    // it into a GameState playing on a board of the same size; the tank table
+    // is replaced, destroyed tanks (which the board no longer shows) included.
+    struct Snapshot {
+        std::vector<Cell> cells;
+        std::vector<Tank> tanks;
+        ShellPool shells;
+        int stepCounter = 0;
+        int emptyAmmoSteps = 0;
+        bool gameOver = false;
+        std::string gameResult;
+    };
+    Snapshot snapshot() const;
+    // Same, reusing the storage of `into`
+    void snapshot(Snapshot& into) const;
+    void restore(const Snapshot& snapshot);
+
+    // Delta undo for search: checkpoint(), any number of step() calls, then
+    // rollback() puts the game and its board back exactly, touching only what
+    // changed. Checkpoints nest; rolling back or releasing one also ends those
+    // taken after it. Log records are not taken back, so search on a GameState
+    // built without a log.
+    using Checkpoint = size_t;
+    Checkpoint checkpoint();
+    void rollback(Checkpoint checkpoint);
+    // Keeps the changes and forgets the checkpoint
+    void release(Checkpoint checkpoint);
+
+    // Everything but the board (saved separately) that the next steps depend on
+    void serialize(ByteWriter& out) const;
+    // Loads state written by serialize(), tank table included; the board must
+    // already match it. Throws std::runtime_error, leaving the state as it
+    // was, on tanks or shells off the board or players outside 1..kMaxPlayers
+    void restore(ByteReader& in);
+
 
 private:
     Board& board;
-    Tank tank1;
-    Tank tank2;
-    std::vector<Shell> shells;
-    std::set<size_t> toRemove;
-    std::map<std::pair<int, int>, std::vector<size_t>> positionMap;
+    std::vector<Tank> tanks;
+    std::vector<int> players;
+    std::vector<std::uint8_t> actsThisStep;   // per tank: alive when the step began
+    ShellPool shells;
+    // Tank and shell collision bookkeeping, sized once and reused every step
+    struct CellVisits {
+        std::uint32_t stamp = 0;    // count is valid when stamp == visitStamp
+        std::uint32_t count = 0;    // tanks or shell visits recorded in the cell
+    };
+    std::vector<CellVisits> cellVisits;
+    std::vector<std::pair<int, size_t>> shellVisits;  // (cell, shell) in recording order
+    std::uint32_t visitStamp = 0;
+
+    // Open checkpoints; frames past checkpointCount are kept for their storage
+    struct CheckpointFrame {
+        size_t journalSize = 0;
+        std::vector<Tank> tanks;
+        ShellPool shells;
+        int stepCounter = 0;
+        int emptyAmmoSteps = 0;
+        bool gameOver = false;
+    };
+    std::vector<CheckpointFrame> checkpoints;
+    size_t checkpointCount = 0;
     int stepCounter = 0; 
+    int emptyAmmoSteps = 0;
+    bool gameOver = false;
+    std::string gameResult;
+    // Striped shell phases (see setStepThreads). Shells are split into one
+    // contiguous chunk per thread and cells into stripes of rows; whatever a
+    // chunk finds for a cell is binned by stripe, and each stripe is then
+    // applied by one thread, so no cell is written by two threads.
+    struct StripeScratch {
+        int chunks = 0;
+        int stripes = 0;
+        size_t minShells = kMinStripedShells;
+        std::vector<int> visitCells;                          // 2 per shell, -1 for none
+        std::vector<std::vector<size_t>> hardShells;          // per chunk
+        std::vector<std::vector<int>> bins;                   // [chunk * stripes + stripe], one extra chunk row
+        std::vector<std::vector<std::pair<int, size_t>>> loneHits;  // per chunk
+        std::vector<std::vector<int>> newlyMarked;            // per stripe
+    };
+    std::unique_ptr<WorkerPool> stepPool;
+    StripeScratch striped;
+    bool stripedShells = false;   // this step's shell phases run striped
+
+    mutable ThreatMap threats;
+    mutable bool threatsStale = true;   // set whenever the shells or walls may have changed
+    StepProfiler profiler;
 
     void applyAction(Tank& tank, Action action);
-    std::pair<int, int> findTank(CellContent tankSymbol);
-    std::ofstream logFile;
+    void wrapTankPositions();
+    void nextVisitStamp();
+    void recordShellVisit(int cellIndex, size_t shellIndex);
+    void moveShell(size_t shellIndex, int* visits);
+    void hitLoneShell(int cellIndex, size_t shellIndex);
+    int stripeOf(int cellIndex) const;
+    void moveShellsStriped();
+    void resolveShellCollisionsStriped();
+    void markShellsStriped();
+    int aliveTankAt(int x, int y) const;
+    void destroyTank(int tankIndex, CellHandle cell);
+    static std::vector<Tank> findTanks(const Board& board);
+    std::vector<std::string> tankLabels() const;
+    GameLog gameLog;
 };
\ No newline at end of file
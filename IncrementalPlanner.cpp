@@ -0,0 +1,220 @@
+#include "IncrementalPlanner.h"
+#include "Board.h"
+#include "BoardGeometry.h"
+#include "PathFinder.h"
+#include <algorithm>
+
+int IncrementalPlanner::heuristic(int a, int b) const {
+    return PathFinder::octileDistance(wrappedDelta(a % width, b % width, width),
+                                      wrappedDelta(a / width, b / width, height));
+}
+
+// Cost of moving between two neighbouring cells; `dir` is the direction from
+// `from` to `to` (the reverse move has the same cost).
+int IncrementalPlanner::edgeCost(int from, int to, int dir) const {
+    if (blocksMovement(board->getCell(from).content) || blocksMovement(board->getCell(to).content))
+        return kInfinity;
+    return dir % 2 == 0 ? PathFinder::kStraightCost : PathFinder::kDiagonalCost;
+}
+
+static int neighborIndex(int index, int dir, int width, int height) {
+    int x = wrapCoord(index % width + kDirDx[dir], width);
+    int y = wrapCoord(index / width + kDirDy[dir], height);
+    return y * width + x;
+}
+
+int IncrementalPlanner::bestSuccessor(int index, int* cost) const {
+    int best = -1, bestCost = kInfinity;
+    for (int d = 0; d < 8; ++d) {
+        int nb = neighborIndex(index, d, width, height);
+        int c = edgeCost(index, nb, d);
+        if (c < kInfinity && c + g[nb] < bestCost) {
+            bestCost = c + g[nb];
+            best = nb;
+        }
+    }
+    *cost = bestCost;
+    return best;
+}
+
+IncrementalPlanner::Key IncrementalPlanner::calculateKey(int index) const {
+    int m = std::min(g[index], rhs[index]);
+    return {m + heuristic(startIndex, index) + km, m};
+}
+
+void IncrementalPlanner::push(int index, Key key) {
+    queued[index] = 1;
+    queuedKey[index] = key;
+    open.push_back({key, index});
+    std::push_heap(open.begin(), open.end(), heapOrder);
+    if (open.size() > 4 * g.size() + 1024)
+        compactOpen();
+}
+
+// Drops stale heap entries once they start to dominate the heap
+void IncrementalPlanner::compactOpen() {
+    auto stale = [&](const OpenEntry& e) { return !queued[e.index] || !(queuedKey[e.index] == e.key); };
+    open.erase(std::remove_if(open.begin(), open.end(), stale), open.end());
+    // A cell may still appear twice with the same key; keep one entry per cell
+    std::sort(open.begin(), open.end(), [](const OpenEntry& a, const OpenEntry& b) { return a.index < b.index; });
+    open.erase(std::unique(open.begin(), open.end(),
+                           [](const OpenEntry& a, const OpenEntry& b) { return a.index == b.index; }),
+               open.end());
+    std::make_heap(open.begin(), open.end(), heapOrder);
+}
+
+bool IncrementalPlanner::popTop(Key& key, int& index) {
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), heapOrder);
+        OpenEntry top = open.back();
+        open.pop_back();
+        if (queued[top.index] && queuedKey[top.index] == top.key) {
+            queued[top.index] = 0;
+            key = top.key;
+            index = top.index;
+            return true;
+        }
+    }
+    return false;
+}
+
+void IncrementalPlanner::enqueueIfInconsistent(int index) {
+    if (g[index] != rhs[index]) {
+        Key key = calculateKey(index);
+        if (!queued[index] || !(queuedKey[index] == key))
+            push(index, key);
+    } else {
+        queued[index] = 0;   // its heap entries are now stale
+    }
+}
+
+void IncrementalPlanner::updateVertex(int index) {
+    if (index != goalIndex) {
+        int cost;
+        bestSuccessor(index, &cost);
+        rhs[index] = cost;
+    }
+    enqueueIfInconsistent(index);
+}
+
+void IncrementalPlanner::reset(const Board& newBoard, int start, int goal) {
+    board = &newBoard;
+    width = newBoard.getWidth();
+    height = newBoard.getHeight();
+    size_t cells = newBoard.getCellCount();
+    g.assign(cells, kInfinity);
+    rhs.assign(cells, kInfinity);
+    queuedKey.assign(cells, Key{0, 0});
+    queued.assign(cells, 0);
+    open.clear();
+    km = 0;
+    startIndex = start;
+    goalIndex = goal;
+    terrainCursor = newBoard.terrainLogEnd();
+    rhs[goal] = 0;
+    enqueueIfInconsistent(goal);
+}
+
+void IncrementalPlanner::applyTerrainChanges(std::span<const int> changes) {
+    for (int cell : changes) {
+        updateVertex(cell);
+        for (int d = 0; d < 8; ++d)
+            updateVertex(neighborIndex(cell, d, width, height));
+    }
+    terrainCursor += changes.size();
+}
+
+// Re-roots the search tree at the target's new cell. Distances that went
+// through the old root are repaired lazily by computeShortestPath.
+void IncrementalPlanner::moveGoal(int newGoal) {
+    int oldGoal = goalIndex;
+    goalIndex = newGoal;
+    rhs[newGoal] = 0;
+    enqueueIfInconsistent(newGoal);
+    updateVertex(oldGoal);
+}
+
+void IncrementalPlanner::computeShortestPath() {
+    while (true) {
+        while (!open.empty() && !(queued[open.front().index] && queuedKey[open.front().index] == open.front().key)) {
+            std::pop_heap(open.begin(), open.end(), heapOrder);
+            open.pop_back();
+        }
+        if (open.empty())
+            break;
+        if (!(open.front().key < calculateKey(startIndex)) && g[startIndex] == rhs[startIndex])
+            break;
+
+        Key oldKey;
+        int u;
+        popTop(oldKey, u);
+        Key newKey = calculateKey(u);
+        if (oldKey < newKey) {
+            push(u, newKey);   // key grew since it was queued (km moved on)
+        } else if (g[u] > rhs[u]) {
+            g[u] = rhs[u];
+            for (int d = 0; d < 8; ++d) {
+                int nb = neighborIndex(u, d, width, height);
+                int c = edgeCost(nb, u, d);
+                if (nb != goalIndex && c < kInfinity && c + g[u] < rhs[nb]) {
+                    rhs[nb] = c + g[u];
+                    enqueueIfInconsistent(nb);
+                }
+            }
+        } else {
+            int oldG = g[u];
+            g[u] = kInfinity;
+            updateVertex(u);
+            for (int d = 0; d < 8; ++d) {
+                int nb = neighborIndex(u, d, width, height);
+                if (nb != goalIndex && rhs[nb] == edgeCost(nb, u, d) + oldG)
+                    updateVertex(nb);
+            }
+        }
+    }
+}
+
+std::optional<Position> IncrementalPlanner::nextStep(const Board& newBoard, Position start, Position goal) {
+    int s = newBoard.index(start.first, start.second);
+    int t = newBoard.index(goal.first, goal.second);
+
+    std::span<const int> changes;
+    if (board != &newBoard || width != newBoard.getWidth() || height != newBoard.getHeight() ||
+        !newBoard.terrainChangesSince(terrainCursor, changes)) {
+        reset(newBoard, s, t);
+    } else {
+        if (s != startIndex) {
+            km += heuristic(startIndex, s);
+            startIndex = s;
+        }
+        applyTerrainChanges(changes);
+        if (t != goalIndex)
+            moveGoal(t);
+    }
+
+    computeShortestPath();
+    if (s == t || g[s] >= kInfinity)
+        return std::nullopt;
+    int cost;
+    int next = bestSuccessor(s, &cost);
+    if (next < 0)
+        return std::nullopt;
+    return Position{next % width, next / width};
+}
+
+void IncrementalPlanner::currentPath(std::vector<Position>& path) const {
+    path.clear();
+    if (!board || startIndex < 0 || g[startIndex] >= kInfinity)
+        return;
+    int at = startIndex;
+    path.push_back({at % width, at / width});
+    for (size_t guard = 0; at != goalIndex && guard < g.size(); ++guard) {
+        int cost;
+        at = bestSuccessor(at, &cost);
+        if (at < 0) {
+            path.clear();
+            return;
+        }
+        path.push_back({at % width, at / width});
+    }
+}
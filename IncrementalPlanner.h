@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+class Board;
+
+using Position = std::pair<int, int>;
+
+// D* Lite planner for a tank chasing a moving target on the wrap-around board.
+//
+// The search tree is rooted at the target and keeps, for every expanded cell,
+// its distance to the target. It survives between calls:
+//  - the chasing tank moving only shifts the heuristic (the km offset),
+//  - a wall or mine disappearing (the board's terrain log) re-opens only
+//    the cells around it,
+//  - the target moving re-roots the tree, and only the cells whose distance
+//    actually changes and that matter for the current start are re-expanded.
+// Costs are the same integer octile costs as PathFinder.
+class IncrementalPlanner {
+public:
+    // Next cell on a shortest path from `start` to `goal`, or nothing if the
+    // goal is unreachable (or already reached).
+    std::optional<Position> nextStep(const Board& board, Position start, Position goal);
+
+    // Cells from start to goal along the current shortest path, both included.
+    // Only valid after nextStep() with the same board.
+    void currentPath(std::vector<Position>& path) const;
+
+private:
+    static constexpr int kInfinity = 1 << 29;
+
+    struct Key {
+        int primary;
+        int secondary;
+        bool operator<(const Key& o) const {
+            return primary < o.primary || (primary == o.primary && secondary < o.secondary);
+        }
+        bool operator==(const Key& o) const { return primary == o.primary && secondary == o.secondary; }
+    };
+    struct OpenEntry {
+        Key key;
+        int index;
+    };
+    static bool heapOrder(const OpenEntry& a, const OpenEntry& b) {
+        return b.key < a.key;   // min-heap on the key
+    }
+
+    const Board* board = nullptr;
+    int width = 0, height = 0;
+    std::vector<int> g;
+    std::vector<int> rhs;
+    std::vector<Key> queuedKey;
+    std::vector<std::uint8_t> queued;   // cell has a live entry in `open`
+    std::vector<OpenEntry> open;        // binary min-heap, may hold stale entries
+    int startIndex = -1;
+    int goalIndex = -1;
+    int km = 0;
+    std::uint64_t terrainCursor = 0;
+
+    void reset(const Board& newBoard, int start, int goal);
+    void applyTerrainChanges(std::span<const int> changes);
+    void moveGoal(int newGoal);
+    void computeShortestPath();
+
+    int heuristic(int a, int b) const;
+    int edgeCost(int from, int to, int dir) const;
+    int bestSuccessor(int index, int* cost) const;
+    Key calculateKey(int index) const;
+    void updateVertex(int index);
+    void enqueueIfInconsistent(int index);
+    void push(int index, Key key);
+    bool popTop(Key& key, int& index);
+    void compactOpen();
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Read-only mapping of a whole file, unmapped when it goes out of scope.
+// An empty file maps to no bytes.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filePath);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file could not be opened
+    bool isOpen() const { return opened; }
+    std::span<const unsigned char> bytes() const { return {data, size}; }
+
+private:
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+    bool opened = false;
+};
@@ -0,0 +1,89 @@
+#include "PathFinder.h"
+#include "Board.h"
+#include "BoardGeometry.h"
+#include <algorithm>
+#include <cstdlib>
+
+int PathFinder::octileDistance(int dx, int dy) {
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    int diagonal = std::min(dx, dy);
+    int straight = std::max(dx, dy) - diagonal;
+    return diagonal * kDiagonalCost + straight * kStraightCost;
+}
+
+void PathFinder::prepare(int cellCount) {
+    if ((int)stamp.size() != cellCount) {
+        gScore.assign(cellCount, 0);
+        parent.assign(cellCount, -1);
+        stamp.assign(cellCount, 0);
+        generation = 0;
+    }
+    if (++generation == 0) {
+        // Stamp counter wrapped around: old stamps could look current again
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    open.clear();
+}
+
+void PathFinder::findPath(const Board& board, Position start, Position goal, std::vector<Position>& path) {
+    path.clear();
+    int width = board.getWidth(), height = board.getHeight();
+    auto inBounds = [&](int x, int y) { return x >= 0 && x < width && y >= 0 && y < height; };
+    if (!inBounds(start.first, start.second) || !inBounds(goal.first, goal.second))
+        return;
+
+    prepare(board.getCellCount());
+    auto heuristic = [&](int x, int y) {
+        return octileDistance(wrappedDelta(x, goal.first, width), wrappedDelta(y, goal.second, height));
+    };
+    auto heapOrder = [](const OpenNode& a, const OpenNode& b) {
+        return a.f > b.f || (a.f == b.f && a.g < b.g);   // prefer deeper nodes on ties
+    };
+
+    int startIndex = board.index(start.first, start.second);
+    int goalIndex = board.index(goal.first, goal.second);
+    gScore[startIndex] = 0;
+    parent[startIndex] = -1;
+    stamp[startIndex] = generation;
+    open.push_back({heuristic(start.first, start.second), 0, startIndex});
+
+    bool reached = false;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), heapOrder);
+        OpenNode cur = open.back();
+        open.pop_back();
+        if (cur.index == goalIndex) {
+            reached = true;
+            break;
+        }
+        if (cur.g > gScore[cur.index])
+            continue;   // stale entry, a cheaper route was found later
+
+        int cx = cur.index % width, cy = cur.index / width;
+        for (int d = 0; d < 8; ++d) {
+            // Moves wrap around the board edges, as in the game itself
+            int nx = wrapCoord(cx + kDirDx[d], width), ny = wrapCoord(cy + kDirDy[d], height);
+            int nb = board.index(nx, ny);
+            CellContent c = board.getCell(nb).content;
+            if (c == CellContent::WALL || c == CellContent::MINE)
+                continue;
+            int tentative = cur.g + (d % 2 == 0 ? kStraightCost : kDiagonalCost);
+            if (stamp[nb] != generation || tentative < gScore[nb]) {
+                stamp[nb] = generation;
+                gScore[nb] = tentative;
+                parent[nb] = cur.index;
+                open.push_back({tentative + heuristic(nx, ny), tentative, nb});
+                std::push_heap(open.begin(), open.end(), heapOrder);
+            }
+        }
+    }
+
+    if (!reached || goalIndex == startIndex)
+        return;
+
+    for (int at = goalIndex; at != -1; at = parent[at])
+        path.push_back({at % width, at / width});
+    std::reverse(path.begin(), path.end());
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Board;
+
+using Position = std::pair<int, int>;
+
+// A* search over the 8-connected, wrap-around board with integer octile costs.
+// The score/parent buffers are kept between searches and invalidated by
+// bumping a generation stamp, so once they have grown to the board size a
+// search neither allocates nor clears anything.
+class PathFinder {
+public:
+    static constexpr int kStraightCost = 10;
+    static constexpr int kDiagonalCost = 14;
+
+    // Fills `path` with the cells from start to goal, both included, avoiding
+    // walls and mines. `path` is left empty when the goal can't be reached.
+    void findPath(const Board& board, Position start, Position goal, std::vector<Position>& path);
+
+    // Octile distance, the exact cost of the shortest path on an open board
+    static int octileDistance(int dx, int dy);
+
+private:
+    struct OpenNode {
+        int f;
+        int g;
+        int index;
+    };
+
+    std::vector<int> gScore;
+    std::vector<int> parent;
+    std::vector<std::uint32_t> stamp;   // gScore/parent of a cell are valid when stamp == generation
+    std::vector<OpenNode> open;         // binary heap ordered by f
+    std::uint32_t generation = 0;
+
+    void prepare(int cellCount);
+};
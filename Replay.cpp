@@ -0,0 +1,155 @@
+#include "Replay.h"
+#include "ByteStream.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static constexpr char kReplayMagic[4] = {'T', 'N', 'K', 'R'};
+// Version 1 stored exactly two actions per step
+static constexpr std::uint32_t kReplayVersion = 2;
+
+Replay::Replay(const Board& initialBoard) : initialBoard(initialBoard) {
+    for (const Cell& cell : initialBoard.cells()) {
+        if (cell.content == CellContent::TANK) ++tankCount;
+    }
+}
+
+void Replay::record(std::span<const Action> stepActions) {
+    if ((int)stepActions.size() != tankCount) {
+        throw std::invalid_argument("Expected one action per tank");
+    }
+    actions.insert(actions.end(), stepActions.begin(), stepActions.end());
+    ++stepCount;
+}
+
+void Replay::getActions(int step, std::vector<Action>& into) const {
+    auto first = actions.begin() + (std::ptrdiff_t)step * tankCount;
+    into.assign(first, first + tankCount);
+}
+
+void Replay::loadKeyframe(int, std::optional<Board>& board, std::optional<GameState>& game) const {
+    game.reset();   // it refers to the board being replaced
+    board.emplace(initialBoard);
+    game.emplace(*board);
+}
+
+void Replay::save(const std::string& filePath, int keyframeInterval) const {
+    if (keyframeInterval <= 0) {
+        throw std::invalid_argument("Keyframe interval must be positive");
+    }
+    std::ofstream out(filePath, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open replay file for writing: " + filePath);
+    }
+
+    int keyframeCount = getStepCount() / keyframeInterval + 1;
+    ByteWriter header;
+    for (char c : kReplayMagic) header.u8((std::uint8_t)c);
+    header.u32(kReplayVersion);
+    header.u32((std::uint32_t)keyframeInterval);
+    header.u32((std::uint32_t)getStepCount());
+    header.u32((std::uint32_t)keyframeCount);
+    header.u32((std::uint32_t)tankCount);
+    std::size_t offsetTable = header.data().size();
+    for (int k = 0; k < keyframeCount; ++k) header.u64(0);   // filled in below
+    for (Action action : actions) header.u8((std::uint8_t)action);
+    out.write(reinterpret_cast<const char*>(header.data().data()), (std::streamsize)header.data().size());
+
+    // Play the game again, saving the state every keyframeInterval steps
+    std::vector<std::uint64_t> offsets;
+    Board board(initialBoard);
+    GameState game(board);
+    for (int step = 0; step <= getStepCount(); ++step) {
+        if (step % keyframeInterval == 0) {
+            offsets.push_back((std::uint64_t)out.tellp());
+            ByteWriter keyframe;
+            board.serialize(keyframe);
+            game.serialize(keyframe);
+            out.write(reinterpret_cast<const char*>(keyframe.data().data()), (std::streamsize)keyframe.data().size());
+        }
+        if (step < getStepCount()) {
+            game.step(std::span<const Action>(actions).subspan((std::size_t)step * tankCount, tankCount));
+        }
+    }
+
+    ByteWriter table;
+    for (std::uint64_t offset : offsets) table.u64(offset);
+    out.seekp((std::streamoff)offsetTable);
+    out.write(reinterpret_cast<const char*>(table.data().data()), (std::streamsize)table.data().size());
+    if (!out) {
+        throw std::runtime_error("Failed to write replay file: " + filePath);
+    }
+}
+
+ReplayFile::ReplayFile(const std::string& filePath) : file(filePath) {
+    if (!file.isOpen()) {
+        throw std::runtime_error("Failed to open replay file: " + filePath);
+    }
+    ByteReader in(file.bytes());
+    if (in.remaining() < sizeof(kReplayMagic) || std::memcmp(in.take(4).data(), kReplayMagic, 4) != 0) {
+        throw std::runtime_error("Not a replay file: " + filePath);
+    }
+    std::uint32_t version = in.u32();
+    if (version != kReplayVersion) {
+        throw std::runtime_error("Unsupported replay file version " + std::to_string(version) + ".");
+    }
+    keyframeInterval = (int)in.u32();
+    stepCount = (int)in.u32();
+    std::uint32_t keyframeCount = in.u32();
+    tankCount = (int)in.u32();
+    if (keyframeInterval <= 0 || stepCount < 0 || tankCount < 0 ||
+        keyframeCount != (std::uint32_t)(stepCount / keyframeInterval + 1)) {
+        throw std::runtime_error("Corrupt replay file header: " + filePath);
+    }
+    keyframeOffsets.resize(keyframeCount);
+    for (std::uint64_t& offset : keyframeOffsets) {
+        offset = in.u64();
+        if (offset >= file.bytes().size()) {
+            throw std::runtime_error("Corrupt replay keyframe table: " + filePath);
+        }
+    }
+    actionBytes = in.take((std::size_t)stepCount * (std::size_t)tankCount);
+    for (unsigned char action : actionBytes) {
+        if (action > (unsigned char)Action::NONE) {
+            throw std::runtime_error("Invalid action in replay file: " + filePath);
+        }
+    }
+}
+
+void ReplayFile::getActions(int step, std::vector<Action>& actions) const {
+    actions.clear();
+    for (unsigned char action : actionBytes.subspan((std::size_t)step * tankCount, tankCount)) {
+        actions.push_back(static_cast<Action>(action));
+    }
+}
+
+int ReplayFile::keyframeBefore(int step) const {
+    return step / keyframeInterval * keyframeInterval;
+}
+
+void ReplayFile::loadKeyframe(int step, std::optional<Board>& board, std::optional<GameState>& game) const {
+    ByteReader in(file.bytes().subspan(keyframeOffsets[step / keyframeInterval]));
+    game.reset();   // it refers to the board being replaced
+    board.emplace(Board::deserialize(in));
+    game.emplace(*board);
+    game->restore(in);
+}
+
+ReplayPlayer::ReplayPlayer(const ReplaySource& source) : source(source) {
+    source.loadKeyframe(0, board, game);
+}
+
+void ReplayPlayer::seek(int target) {
+    if (target < 0 || target > source.getStepCount()) {
+        throw std::out_of_range("Replay step " + std::to_string(target) + " is out of range");
+    }
+    int keyframe = source.keyframeBefore(target);
+    if (target < step || keyframe > step) {
+        source.loadKeyframe(target, board, game);
+        step = keyframe;
+    }
+    for (; step < target; ++step) {
+        source.getActions(step, actions);
+        game->step(actions);
+    }
+}
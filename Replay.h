@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Board.h"
+#include "GameState.h"
+#include "MappedFile.h"
+#include "Tank.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// A recorded game that a ReplayPlayer can rebuild any step of: the actions
+// of every step, plus stored states (keyframes) to start replaying from.
+// The rules are deterministic, so nothing else is needed.
+class ReplaySource {
+public:
+    virtual ~ReplaySource() = default;
+
+    virtual int getStepCount() const = 0;
+    // Tanks in the game's tank table, each with one action per step
+    virtual int getTankCount() const = 0;
+    // Replaces `actions` with the actions of `step`, in tank table order
+    virtual void getActions(int step, std::vector<Action>& actions) const = 0;
+    // Step of the latest keyframe at or before `step`
+    virtual int keyframeBefore(int step) const = 0;
+    // Replaces `board` and `game` with the keyframe keyframeBefore(step)
+    virtual void loadKeyframe(int step, std::optional<Board>& board, std::optional<GameState>& game) const = 0;
+};
+
+// A game being recorded in memory: the board it started from plus the
+// actions of each step. Its only keyframe is the start.
+class Replay : public ReplaySource {
+public:
+    explicit Replay(const Board& initialBoard);
+
+    // One action per tank, as passed to GameState::step
+    void record(std::span<const Action> stepActions);
+    const Board& getInitialBoard() const { return initialBoard; }
+
+    int getStepCount() const override { return stepCount; }
+    int getTankCount() const override { return tankCount; }
+    void getActions(int step, std::vector<Action>& into) const override;
+    int keyframeBefore(int) const override { return 0; }
+    void loadKeyframe(int step, std::optional<Board>& board, std::optional<GameState>& game) const override;
+
+    // Writes a replay file (see ReplayFile) with a keyframe every
+    // `keyframeInterval` steps. The keyframes come from playing the game again.
+    void save(const std::string& filePath, int keyframeInterval = kDefaultKeyframeInterval) const;
+
+    static constexpr int kDefaultKeyframeInterval = 100;
+
+private:
+    Board initialBoard;
+    int tankCount = 0;
+    int stepCount = 0;
+    std::vector<Action> actions;    // tankCount per step
+};
+
+// A replay file, memory-mapped so that only the keyframe being restored and
+// the actions being replayed are read. Layout (integers are little-endian):
+//   "TNKR", u32 version, u32 keyframe interval K, u32 step count, u32 keyframe count,
+//   u32 tank count T
+//   u64 file offset of each keyframe (keyframe i is the state after i * K steps)
+//   T bytes per step: the actions in tank table order
+//   keyframes: the serialized Board followed by the serialized GameState
+class ReplayFile : public ReplaySource {
+public:
+    explicit ReplayFile(const std::string& filePath);
+
+    int getStepCount() const override { return stepCount; }
+    int getTankCount() const override { return tankCount; }
+    void getActions(int step, std::vector<Action>& actions) const override;
+    int keyframeBefore(int step) const override;
+    void loadKeyframe(int step, std::optional<Board>& board, std::optional<GameState>& game) const override;
+
+private:
+    MappedFile file;
+    int keyframeInterval = 0;
+    int stepCount = 0;
+    int tankCount = 0;
+    std::vector<std::uint64_t> keyframeOffsets;
+    std::span<const unsigned char> actionBytes;
+};
+
+// Rebuilds the game state after any number of steps of a replay. It starts
+// from the closest keyframe unless the current state is already closer, and
+// plays the steps in between.
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const ReplaySource& source);
+
+    // Brings the game to the state after `step` steps (0 = the start)
+    void seek(int step);
+    int getStep() const { return step; }
+    const Board& getBoard() const { return *board; }
+    const GameState& getGame() const { return *game; }
+
+private:
+    const ReplaySource& source;
+    std::optional<Board> board;
+    std::optional<GameState> game;   // plays on *board
+    std::vector<Action> actions;     // of the step being replayed
+    int step = 0;
+};
@@ -0,0 +1,171 @@
+#include "SearchEngine.h"
+#include "BoardGeometry.h"
+#include <algorithm>
+#include <cmath>
+
+// splitmix64: small, fast and good enough for picking rollout moves
+static std::uint64_t nextRandom(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Rollout policy: mostly fire when the nearest enemy is straight ahead in the
+// open, otherwise any of the 8 actions at random
+static Action rolloutAction(const GameState& game, const Board& board, int tankIndex, std::uint64_t& rng) {
+    const Tank& tank = game.getTank(tankIndex);
+    std::uint64_t r = nextRandom(rng);
+    int enemy = game.nearestEnemy(tankIndex);
+    if (tank.canShoot() && (r & 3) != 0 && enemy >= 0) {
+        auto direction = lineOfSightDirection(board, tank.getPosition(), game.getTank(enemy).getPosition());
+        if (direction && *direction == tank.getDirection()) return Action::SHOOT;
+    }
+    return static_cast<Action>((r >> 8) % 8);
+}
+
+// Rollout actions of every living tank but `skipTank` into `actions`
+static void rolloutActions(const GameState& game, const Board& board, std::vector<Action>& actions,
+                           std::uint64_t& rng, int skipTank = -1) {
+    actions.assign(game.getTankCount(), Action::NONE);
+    for (int i = 0; i < game.getTankCount(); ++i) {
+        if (i != skipTank && game.getTank(i).isAlive()) actions[i] = rolloutAction(game, board, i, rng);
+    }
+}
+
+SearchEngine::SearchEngine(const SearchOptions& options) : options(options) {
+    int threadCount = options.threads > 0 ? options.threads
+                                          : (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int t = 0; t < threadCount; ++t) {
+        workers.push_back(std::make_unique<Worker>());
+        Worker& worker = *workers.back();
+        worker.rng = options.seed + (std::uint64_t)t * 0x632BE59BD9B4E019ULL;
+        worker.thread = std::thread([this, &worker] { workerLoop(worker); });
+    }
+}
+
+SearchEngine::~SearchEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker->thread.join();
+}
+
+Action SearchEngine::decide(const GameState& game, const Board& board, int tankIndex) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        game.snapshot(rootSnapshot);
+        rootBoard = &board;
+        rootTank = tankIndex;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeBudgetMs);
+        busyWorkers = (int)workers.size();
+        ++jobId;
+    }
+    wake.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busyWorkers == 0; });
+    }
+
+    long long visits[kActions] = {};
+    double value[kActions] = {};
+    for (const auto& worker : workers) {
+        for (int a = 0; a < kActions; ++a) {
+            visits[a] += worker->visits[a];
+            value[a] += worker->value[a];
+        }
+    }
+
+    // Most visited action; UCB concentrates visits on the best one
+    int best = 0;
+    lastRollouts = 0;
+    for (int a = 0; a < kActions; ++a) {
+        lastRollouts += visits[a];
+        if (visits[a] > visits[best] ||
+            (visits[a] == visits[best] && visits[a] > 0 && value[a] / visits[a] > value[best] / visits[best]))
+            best = a;
+    }
+    return static_cast<Action>(best);
+}
+
+void SearchEngine::workerLoop(Worker& worker) {
+    std::uint64_t seenJob = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || jobId != seenJob; });
+            if (stopping) return;
+            seenJob = jobId;
+        }
+
+        // Reset the private copy to the root position; it is only rebuilt
+        // from scratch for the first move or a different board size. The
+        // cells restore() changes go through the terrain log, so the sight
+        // table catches up on them instead of being rebuilt
+        if (!worker.board || worker.board->getWidth() != rootBoard->getWidth() ||
+            worker.board->getHeight() != rootBoard->getHeight()) {
+            worker.game.reset();
+            worker.board.emplace(*rootBoard);
+            worker.game.emplace(*worker.board);
+        }
+        worker.game->restore(rootSnapshot);
+        search(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) done.notify_one();
+    }
+}
+
+void SearchEngine::search(Worker& worker) {
+    std::fill(std::begin(worker.visits), std::end(worker.visits), 0);
+    std::fill(std::begin(worker.value), std::end(worker.value), 0.0);
+    long long total = 0;
+
+    do {
+        // UCB1: try every action once, then balance mean score and uncertainty
+        int pick = 0;
+        double bestScore = -1.0;
+        for (int a = 0; a < kActions; ++a) {
+            if (worker.visits[a] == 0) {
+                pick = a;
+                break;
+            }
+            double mean = worker.value[a] / worker.visits[a];
+            double score = mean + options.exploration * std::sqrt(std::log((double)total) / worker.visits[a]);
+            if (score > bestScore) {
+                bestScore = score;
+                pick = a;
+            }
+        }
+
+        double result = rollout(worker, pick);
+        worker.visits[pick]++;
+        worker.value[pick] += result;
+        total++;
+    } while (std::chrono::steady_clock::now() < deadline);
+}
+
+// Plays `firstAction` and then the rollout policy for all tanks; returns 1
+// for a win of the searching tank's player, 0 for a loss and 0.5 otherwise
+double SearchEngine::rollout(Worker& worker, int firstAction) {
+    GameState& game = *worker.game;
+    const Board& board = *worker.board;
+    GameState::Checkpoint checkpoint = game.checkpoint();
+    int rootPlayer = game.getTank(rootTank).getPlayerId();
+
+    rolloutActions(game, board, worker.actions, worker.rng, rootTank);
+    worker.actions[rootTank] = static_cast<Action>(firstAction);
+    game.step(worker.actions);
+
+    for (int depth = 0; depth < options.rolloutDepth && !game.isGameOver(); ++depth) {
+        rolloutActions(game, board, worker.actions, worker.rng);
+        game.step(worker.actions);
+    }
+
+    int winner = game.getWinner();
+    double result = winner == rootPlayer ? 1.0 : winner == 0 ? 0.5 : 0.0;
+    game.rollback(checkpoint);
+    return result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Board.h"
+#include "GameState.h"
+#include "Tank.h"
+#include "TankAlgorithm.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct SearchOptions {
+    int threads = 0;            // 0 = one per hardware thread
+    int timeBudgetMs = 50;      // thinking time per move
+    int rolloutDepth = 40;      // steps played after the first one before scoring
+    double exploration = 1.4;   // UCB1 exploration constant
+    std::uint64_t seed = 1;
+};
+
+// Flat Monte Carlo search with UCB1 over the 8 actions of one tank.
+//
+// Every rollout plays a candidate action for our tank against the other tanks'
+// rollout policy with the real GameState::step rules, then keeps playing all
+// tanks with that policy for a few dozen steps and scores the outcome. Each
+// worker thread owns a copy of the game that it resets to the root position
+// once per move and then reuses through checkpoint/rollback, so rollouts
+// allocate nothing; workers keep their own statistics and they are only
+// summed when the time budget is spent.
+class SearchEngine {
+public:
+    explicit SearchEngine(const SearchOptions& options = {});
+    ~SearchEngine();
+    SearchEngine(const SearchEngine&) = delete;
+    SearchEngine& operator=(const SearchEngine&) = delete;
+
+    // Best action for tank `tankIndex` of `game` in its current state
+    Action decide(const GameState& game, const Board& board, int tankIndex);
+
+    // Rollouts played for the last decision, summed over all workers
+    long long getLastRolloutCount() const { return lastRollouts; }
+
+private:
+    static constexpr int kActions = 8;
+
+    struct Worker {
+        std::optional<Board> board;
+        std::optional<GameState> game;   // log-less, plays on *board
+        std::uint64_t rng = 0;
+        long long visits[kActions] = {};
+        double value[kActions] = {};
+        std::vector<Action> actions;     // rollout step actions, reused
+        std::thread thread;
+    };
+
+    SearchOptions options;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Current job, published under `mutex`
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t jobId = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+    const Board* rootBoard = nullptr;
+    GameState::Snapshot rootSnapshot;
+    int rootTank = 0;
+    std::chrono::steady_clock::time_point deadline;
+    long long lastRollouts = 0;
+
+    void workerLoop(Worker& worker);
+    void search(Worker& worker);
+    double rollout(Worker& worker, int firstAction);
+};
+
+// The search engine as a pluggable algorithm ("search" in the registry)
+class SearchAlgorithm : public TankAlgorithm {
+public:
+    explicit SearchAlgorithm(const SearchOptions& options) : engine(options) {}
+    Action decide(const GameView& view) override {
+        return engine.decide(view.getGame(), view.getBoard(), view.getTankIndex());
+    }
+
+private:
+    SearchEngine engine;
+};
@@ -0,0 +1,113 @@
+#include "ShellPool.h"
+#include "BoardGeometry.h"
+#include "ByteStream.h"
+
+void ShellPool::push(int x, int y, Direction dir) {
+    int d = static_cast<int>(dir);
+    xs.push_back(x);
+    ys.push_back(y);
+    dxs.push_back(kDirDx[d]);
+    dys.push_back(kDirDy[d]);
+    dirs.push_back(static_cast<std::uint8_t>(d));
+    alive.push_back(1);
+}
+
+void ShellPool::clear() {
+    xs.clear();
+    ys.clear();
+    dxs.clear();
+    dys.clear();
+    dirs.clear();
+    alive.clear();
+}
+
+// One sub-step of `count` coordinates. A coordinate moves by at most one
+// cell, so wrapping is a single add of +size or -size chosen by compares.
+static void stepAxis(const int* from, const int* delta, int* to, std::uint8_t* crossed,
+                     std::uint8_t crossedBit, std::size_t count, int size) {
+    for (std::size_t i = 0; i < count; ++i) {
+        int v = from[i] + delta[i];
+        int low = v < 0;
+        int high = v >= size;
+        to[i] = v + (low - high) * size;
+        crossed[i] |= static_cast<std::uint8_t>((low | high) * crossedBit);
+    }
+}
+
+void ShellPool::advance(int width, int height) {
+    beginAdvance();
+    advanceRange(width, height, 0, xs.size());
+}
+
+void ShellPool::beginAdvance() {
+    std::size_t count = xs.size();
+    midXs.resize(count);
+    midYs.resize(count);
+    crossed.assign(count, 0);
+}
+
+void ShellPool::advanceRange(int width, int height, std::size_t begin, std::size_t end) {
+    std::size_t count = end - begin;
+    int* x = xs.data() + begin;
+    int* y = ys.data() + begin;
+    int* midX = midXs.data() + begin;
+    int* midY = midYs.data() + begin;
+    std::uint8_t* edges = crossed.data() + begin;
+    stepAxis(x, dxs.data() + begin, midX, edges, 1, count, width);
+    stepAxis(y, dys.data() + begin, midY, edges, 1, count, height);
+    stepAxis(midX, dxs.data() + begin, x, edges, 2, count, width);
+    stepAxis(midY, dys.data() + begin, y, edges, 2, count, height);
+}
+
+void ShellPool::compact() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        if (!alive[i]) continue;
+        xs[kept] = xs[i];
+        ys[kept] = ys[i];
+        dxs[kept] = dxs[i];
+        dys[kept] = dys[i];
+        dirs[kept] = dirs[i];
+        alive[kept] = 1;
+        ++kept;
+    }
+    xs.resize(kept);
+    ys.resize(kept);
+    dxs.resize(kept);
+    dys.resize(kept);
+    dirs.resize(kept);
+    alive.resize(kept);
+}
+
+void ShellPool::copyShellsFrom(const ShellPool& other) {
+    xs.assign(other.xs.begin(), other.xs.end());
+    ys.assign(other.ys.begin(), other.ys.end());
+    dxs.assign(other.dxs.begin(), other.dxs.end());
+    dys.assign(other.dys.begin(), other.dys.end());
+    dirs.assign(other.dirs.begin(), other.dirs.end());
+    alive.assign(other.alive.begin(), other.alive.end());
+}
+
+void ShellPool::serialize(ByteWriter& out) const {
+    out.u32((std::uint32_t)xs.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        out.i32(xs[i]);
+        out.i32(ys[i]);
+        out.u8(dirs[i]);
+    }
+}
+
+ShellPool ShellPool::deserialize(ByteReader& in) {
+    ShellPool pool;
+    std::uint32_t count = in.u32();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        int x = in.i32();
+        int y = in.i32();
+        std::uint8_t dir = in.u8();
+        if (dir > (std::uint8_t)Direction::UL) {
+            throw std::runtime_error("Invalid shell direction in saved data.");
+        }
+        pool.push(x, y, static_cast<Direction>(dir));
+    }
+    return pool;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Tank.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ByteWriter;
+class ByteReader;
+
+// Shells in flight, stored as parallel arrays so a turn's movement is a few
+// straight passes over plain ints instead of a per-shell switch.
+//
+// Moving is split in two:
+//  - advance() computes both sub-step positions of every shell, wrapping
+//    around the board without branches,
+//  - GameState then walks the shells in order to apply what they hit, since
+//    a shell may break a wall or a tank that a later shell would have hit.
+// Removed shells are only marked dead; compact() drops them in place.
+class ShellPool {
+public:
+    std::size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+
+    void push(int x, int y, Direction dir);
+    void clear();
+
+    int x(std::size_t i) const { return xs[i]; }
+    int y(std::size_t i) const { return ys[i]; }
+    Direction dir(std::size_t i) const { return static_cast<Direction>(dirs[i]); }
+
+    // Position after the first sub-step of the last advance()
+    int midX(std::size_t i) const { return midXs[i]; }
+    int midY(std::size_t i) const { return midYs[i]; }
+    // Bit 0: the first sub-step crossed a board edge, bit 1: the second did
+    std::uint8_t crossedEdges(std::size_t i) const { return crossed[i]; }
+
+    // Moves every shell two cells along its direction on a width x height
+    // torus. x()/y() become the final cell; the midway cell and the crossed
+    // edges are kept until the next advance().
+    void advance(int width, int height);
+    // The same in two parts, so that disjoint ranges of shells can advance on
+    // different threads: beginAdvance() once, then advanceRange() per range
+    void beginAdvance();
+    void advanceRange(int width, int height, std::size_t begin, std::size_t end);
+
+    bool isAlive(std::size_t i) const { return alive[i] != 0; }
+    void kill(std::size_t i) { alive[i] = 0; }
+
+    // Drops dead shells, keeping the survivors in order
+    void compact();
+
+    // Copies the shells of `other` (not its per-turn scratch), reusing this
+    // pool's storage
+    void copyShellsFrom(const ShellPool& other);
+
+    // Saves the shells in flight (call between turns, when all are alive)
+    void serialize(ByteWriter& out) const;
+    static ShellPool deserialize(ByteReader& in);
+
+private:
+    std::vector<int> xs, ys;
+    std::vector<int> dxs, dys;
+    std::vector<std::uint8_t> dirs;
+    std::vector<std::uint8_t> alive;
+    // Per-turn scratch filled by advance()
+    std::vector<int> midXs, midYs;
+    std::vector<std::uint8_t> crossed;
+};
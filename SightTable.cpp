@@ -0,0 +1,132 @@
+#include "SightTable.h"
+#include "Board.h"
+#include "BoardGeometry.h"
+#include <algorithm>
+#include <numeric>
+
+int SightTable::stepBack(int cell, int dir) const {
+    int x = wrapCoord(cell % width - kDirDx[dir], width);
+    int y = wrapCoord(cell / width - kDirDy[dir], height);
+    return y * width + x;
+}
+
+void SightTable::build(const Board& board) {
+    width = board.getWidth();
+    height = board.getHeight();
+    int cells = board.getCellCount();
+    dist.assign((std::size_t)cells * 8, kFar);
+    isWall.assign(cells, 0);
+    for (int c = 0; c < cells; ++c)
+        isWall[c] = board.getCell(c).content == CellContent::WALL;
+
+    std::vector<std::uint8_t> visited;
+    for (int d = 0; d < 8; ++d) {
+        int dx = kDirDx[d], dy = kDirDy[d];
+        period[d] = dx == 0 ? height : dy == 0 ? width : std::lcm((long long)width, (long long)height);
+
+        // The ray cells of one direction split into orbits; walk each orbit
+        // backwards from one of its walls so every distance is known when needed.
+        visited.assign(cells, 0);
+        for (int c = 0; c < cells; ++c) {
+            if (visited[c]) continue;
+            orbit.clear();
+            int lastWall = -1;
+            for (int at = c; !visited[at];) {
+                visited[at] = 1;
+                if (isWall[at]) lastWall = (int)orbit.size();
+                orbit.push_back(at);
+                at = wrapCoord(at / width + dy, height) * width + wrapCoord(at % width + dx, width);
+            }
+            if (lastWall < 0) continue;   // no wall on this orbit: every distance stays kFar
+
+            int length = (int)orbit.size();
+            int ahead = 0;   // distance from the previous orbit cell to its nearest wall
+            for (int n = 1; n <= length; ++n) {
+                int i = ((lastWall - n) % length + length) % length;
+                int next = orbit[(i + 1) % length];
+                ahead = isWall[next] ? 1 : std::min<int>(ahead + 1, kFar);
+                dist[(std::size_t)orbit[i] * 8 + d] = (std::uint16_t)ahead;
+            }
+        }
+    }
+    orbit.clear();
+    orbit.shrink_to_fit();
+    terrainCursor = board.terrainLogEnd();
+    built = true;
+}
+
+// Cells whose nearest wall along a ray was `cell` now see the wall beyond it
+void SightTable::removeWall(int cell) {
+    isWall[cell] = 0;
+    for (int d = 0; d < 8; ++d) {
+        int beyond = dist[(std::size_t)cell * 8 + d];
+        // A ray that comes back to `cell` without meeting another wall is now open
+        long long reopened = beyond == period[d] || beyond == kFar ? kFar : beyond;
+        int at = cell;
+        for (long long k = 1; k <= period[d] && k < kFar; ++k) {
+            at = stepBack(at, d);
+            std::uint16_t& entry = dist[(std::size_t)at * 8 + d];
+            if (entry != k) break;
+            entry = (std::uint16_t)std::min<long long>(k + reopened, kFar);
+        }
+    }
+}
+
+// Cells behind a new wall whose nearest wall was further away now stop at it
+void SightTable::addWall(int cell) {
+    isWall[cell] = 1;
+    for (int d = 0; d < 8; ++d) {
+        int at = cell;
+        for (long long k = 1; k <= period[d] && k < kFar; ++k) {
+            at = stepBack(at, d);
+            std::uint16_t& entry = dist[(std::size_t)at * 8 + d];
+            if (entry <= k) break;
+            entry = (std::uint16_t)k;
+        }
+    }
+}
+
+void SightTable::sync(const Board& board) {
+    std::span<const int> changes;
+    if (!built || width != board.getWidth() || height != board.getHeight() ||
+        !board.terrainChangesSince(terrainCursor, changes)) {
+        build(board);
+        return;
+    }
+    for (int cell : changes) {
+        bool wall = board.getCell(cell).content == CellContent::WALL;
+        if (wall == (bool)isWall[cell]) continue;   // a mine, or already applied
+        if (wall) addWall(cell);
+        else removeWall(cell);
+    }
+    terrainCursor += changes.size();
+}
+
+std::optional<Direction> SightTable::firingDirection(const Board& board, Position from, Position to) const {
+    std::optional<Direction> best;
+    int bestDistance = 0;
+    int fromCell = board.index(from.first, from.second);
+    for (int d = 0; d < 8; ++d) {
+        Direction dir = static_cast<Direction>(d);
+        int distance = rayDistance(board, from, to, dir);
+        if (distance <= 0 || (best && distance >= bestDistance))
+            continue;
+
+        int wall = wallDistance(fromCell, dir);
+        bool clear = distance < wall;
+        if (!clear && wall == kFar) {
+            // Too far for the table to tell: walk the ray
+            clear = true;
+            Position p = from;
+            for (int s = 1; s <= distance && clear; ++s) {
+                p = wrappedNeighbor(board, p, dir);
+                clear = board.getCell(p.first, p.second).content != CellContent::WALL;
+            }
+        }
+        if (clear) {
+            best = dir;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
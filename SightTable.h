@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Tank.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class Board;
+
+using Position = std::pair<int, int>;
+
+// For every cell and each of the 8 directions, the number of steps along the
+// (wrap-around) ray to the nearest wall. Line-of-sight queries become a table
+// lookup plus solving where the ray meets the target; destroyed or new walls
+// only rewrite the ray segments that ended at them.
+class SightTable {
+public:
+    // Distances at or beyond this value are stored as kFar
+    static constexpr std::uint16_t kFar = 0xFFFF;
+
+    // Brings the table up to date with the board, building it on first use
+    // and afterwards replaying the board's terrain log (rebuilding if the
+    // log no longer reaches back to the last sync).
+    void sync(const Board& board);
+    // Forces a rebuild on the next sync (keeps the storage)
+    void invalidate() { built = false; }
+
+    // Steps from `cell` along `dir` to the nearest wall (kFar if none is near)
+    int wallDistance(int cell, Direction dir) const { return dist[(std::size_t)cell * 8 + (int)dir]; }
+
+    // Direction of the shortest wall-free firing ray from `from` to `to`
+    std::optional<Direction> firingDirection(const Board& board, Position from, Position to) const;
+
+private:
+    std::vector<std::uint16_t> dist;        // cell * 8 + direction
+    std::vector<std::uint8_t> isWall;       // wall layout the table reflects
+    std::vector<int> orbit;                 // scratch for build()
+    int width = 0, height = 0;
+    long long period[8] = {};               // steps until a ray returns to its start
+    std::uint64_t terrainCursor = 0;
+    bool built = false;
+
+    void build(const Board& board);
+    void removeWall(int cell);
+    void addWall(int cell);
+    int stepBack(int cell, int dir) const;
+};
@@ -0,0 +1,106 @@
+#include "StepProfiler.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iomanip>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+const char* toString(StepPhase phase) {
+    switch (phase) {
+        case StepPhase::APPLY_ACTIONS:    return "apply_actions";
+        case StepPhase::MINES:            return "mines";
+        case StepPhase::COOLDOWNS:        return "cooldowns";
+        case StepPhase::BACKWARD_MOVES:   return "backward_moves";
+        case StepPhase::TANK_MARKS:       return "tank_marks";
+        case StepPhase::SHELL_MOVES:      return "shell_moves";
+        case StepPhase::SHELL_COLLISIONS: return "shell_collisions";
+        case StepPhase::SHELL_CLEANUP:    return "shell_cleanup";
+        case StepPhase::SHOOTING:         return "shooting";
+        case StepPhase::END_CONDITIONS:   return "end_conditions";
+        case StepPhase::DECIDE_P1:        return "decide_p1";
+        case StepPhase::DECIDE_P2:        return "decide_p2";
+        default:                          return "unknown";
+    }
+}
+
+std::uint64_t StepProfiler::now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* StepProfiler::tickUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+void StepProfiler::record(StepPhase phase, std::uint64_t ticks) {
+    if (phases.empty()) phases.resize((size_t)StepPhase::COUNT);
+    PhaseStats& s = phases[(size_t)phase];
+    s.calls++;
+    s.totalTicks += ticks;
+    s.minTicks = std::min(s.minTicks, ticks);
+    s.maxTicks = std::max(s.maxTicks, ticks);
+    s.histogram[std::min<int>((int)std::bit_width(ticks), kBuckets - 1)]++;
+}
+
+void StepProfiler::merge(const StepProfiler& other) {
+    if (other.phases.empty()) return;
+    if (phases.empty()) phases.resize((size_t)StepPhase::COUNT);
+    for (size_t p = 0; p < phases.size(); ++p) {
+        PhaseStats& s = phases[p];
+        const PhaseStats& o = other.phases[p];
+        s.calls += o.calls;
+        s.totalTicks += o.totalTicks;
+        s.minTicks = std::min(s.minTicks, o.minTicks);
+        s.maxTicks = std::max(s.maxTicks, o.maxTicks);
+        for (int b = 0; b < kBuckets; ++b) s.histogram[b] += o.histogram[b];
+    }
+}
+
+const StepProfiler::PhaseStats& StepProfiler::stats(StepPhase phase) const {
+    static const PhaseStats none;
+    return phases.empty() ? none : phases[(size_t)phase];
+}
+
+void StepProfiler::report(std::ostream& out) const {
+    if (phases.empty()) {
+        out << "No profile recorded" << (kProfilingEnabled ? "" : " (built without TANK_PROFILE)") << ".\n";
+        return;
+    }
+    std::uint64_t stepTicks = 0;
+    for (int p = 0; p < (int)StepPhase::DECIDE_P1; ++p) stepTicks += phases[p].totalTicks;
+
+    out << "Phase profile (" << tickUnit() << "; share is of the time spent in step)\n";
+    out << std::left << std::setw(18) << "phase" << std::right << std::setw(10) << "calls" << std::setw(14)
+        << "mean" << std::setw(12) << "min" << std::setw(14) << "max" << std::setw(9) << "share" << '\n';
+    for (int p = 0; p < (int)StepPhase::COUNT; ++p) {
+        const PhaseStats& s = phases[p];
+        if (s.calls == 0) continue;
+        out << std::left << std::setw(18) << toString((StepPhase)p) << std::right << std::setw(10) << s.calls
+            << std::setw(14) << std::fixed << std::setprecision(1) << (double)s.totalTicks / s.calls
+            << std::setw(12) << s.minTicks << std::setw(14) << s.maxTicks;
+        if (p < (int)StepPhase::DECIDE_P1 && stepTicks > 0)
+            out << std::setw(8) << 100.0 * s.totalTicks / stepTicks << '%';
+        out << '\n';
+    }
+
+    out << "Histograms (bucket 2^k holds durations below 2^k " << tickUnit() << ")\n";
+    for (int p = 0; p < (int)StepPhase::COUNT; ++p) {
+        const PhaseStats& s = phases[p];
+        if (s.calls == 0) continue;
+        out << std::left << std::setw(18) << toString((StepPhase)p) << std::right;
+        for (int b = 0; b < kBuckets; ++b)
+            if (s.histogram[b] > 0) out << " 2^" << b << ':' << s.histogram[b];
+        out << '\n';
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Opt-in timing of the phases of GameState::step and of the algorithms'
+// decisions. Configure with -DTANK_PROFILE=ON to turn it on; otherwise
+// kProfilingEnabled is false, every ProfileScope compiles to nothing and the
+// profilers stay empty.
+#ifdef TANK_PROFILE
+inline constexpr bool kProfilingEnabled = true;
+#else
+inline constexpr bool kProfilingEnabled = false;
+#endif
+
+// In the order GameState::step runs them, then the two algorithm decisions
+enum class StepPhase {
+    APPLY_ACTIONS,
+    MINES,
+    COOLDOWNS,
+    BACKWARD_MOVES,
+    TANK_MARKS,
+    SHELL_MOVES,
+    SHELL_COLLISIONS,
+    SHELL_CLEANUP,
+    SHOOTING,
+    END_CONDITIONS,
+    DECIDE_P1,
+    DECIDE_P2,
+    COUNT
+};
+
+const char* toString(StepPhase phase);
+
+// Call counts, tick totals and log2 histograms per phase. Ticks are TSC
+// cycles on x86 and nanoseconds elsewhere.
+class StepProfiler {
+public:
+    static constexpr int kBuckets = 48;   // bucket b counts durations in [2^(b-1), 2^b)
+
+    struct PhaseStats {
+        std::uint64_t calls = 0;
+        std::uint64_t totalTicks = 0;
+        std::uint64_t minTicks = UINT64_MAX;
+        std::uint64_t maxTicks = 0;
+        std::array<std::uint64_t, kBuckets> histogram{};
+    };
+
+    static std::uint64_t now();
+    static const char* tickUnit();
+
+    void record(StepPhase phase, std::uint64_t ticks);
+    // Adds the counts of `other` (e.g. another game or thread) to this one
+    void merge(const StepProfiler& other);
+    bool empty() const { return phases.empty(); }
+    const PhaseStats& stats(StepPhase phase) const;
+
+    // Table of every phase that ran, followed by the non-empty histogram buckets
+    void report(std::ostream& out) const;
+
+private:
+    std::vector<PhaseStats> phases;   // allocated on the first record()
+};
+
+// Times its own lifetime into `profiler` under `phase`
+class ProfileScope {
+public:
+    ProfileScope(StepProfiler& profiler, StepPhase phase) {
+        if constexpr (kProfilingEnabled) {
+            this->profiler = &profiler;
+            this->phase = phase;
+            start = StepProfiler::now();
+        }
+    }
+    ~ProfileScope() {
+        if constexpr (kProfilingEnabled) profiler->record(phase, StepProfiler::now() - start);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    StepProfiler* profiler = nullptr;
+    StepPhase phase = StepPhase::COUNT;
+    std::uint64_t start = 0;
+};
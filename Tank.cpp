@@ -1,4 +1,5 @@
 #include "Tank.h"
+#include "ByteStream.h"
 
 Tank::Tank(int playerId, int x, int y, Direction dir)
     : playerId(playerId), x(x), y(y), direction(dir) {}
@@ -11,6 +12,8 @@ Direction Tank::getDirection() const { return direction; }
 
 int Tank::getShellCount() const { return shellCount; }
 
+int Tank::getShootCooldown() const { return shootCooldown; }
+
 bool Tank::canShoot() const { return shootCooldown == 0 && shellCount > 0; }
 
 bool Tank::isWaitingToMoveBack() const { return backwardRequested && backwardDelay > 0; }
@@ -21,6 +24,35 @@ void Tank::destroy() {
     alive = false;
 }
 
+void Tank::serialize(ByteWriter& out) const {
+    out.i32(playerId);
+    out.i32(x);
+    out.i32(y);
+    out.u8((std::uint8_t)direction);
+    out.i32(shellCount);
+    out.i32(shootCooldown);
+    out.u8(alive);
+    out.i32(backwardDelay);
+    out.u8(backwardRequested);
+}
+
+Tank Tank::deserialize(ByteReader& in) {
+    int playerId = in.i32();
+    int x = in.i32();
+    int y = in.i32();
+    std::uint8_t direction = in.u8();
+    if (direction > (std::uint8_t)Direction::UL) {
+        throw std::runtime_error("Invalid tank direction in saved data.");
+    }
+    Tank tank(playerId, x, y, static_cast<Direction>(direction));
+    tank.shellCount = in.i32();
+    tank.shootCooldown = in.i32();
+    tank.alive = in.u8() != 0;
+    tank.backwardDelay = in.i32();
+    tank.backwardRequested = in.u8() != 0;
+    return tank;
+}
+
 void Tank::updateCooldowns() {
     if (shootCooldown > 0) shootCooldown--;
     if (backwardRequested && backwardDelay > 0) backwardDelay--;
@@ -96,6 +128,10 @@ void Tank::moveBackward() {
     }
 }
 
+void Tank::setPosition(int newX, int newY) {
+    x = newX;
+    y = newY;
+}
 
 
 std::string toString(Direction dir) {
@@ -3,6 +3,9 @@
 #include <string>
 #include <utility>
 
+class ByteWriter;
+class ByteReader;
+
 enum class Direction {
     U, UR, R, DR, D, DL, L, UL
 };
@@ -29,6 +32,7 @@ public:
     std::pair<int, int> getPosition() const;
     Direction getDirection() const;
     int getShellCount() const;
+    int getShootCooldown() const;
     bool canShoot() const;
     bool isWaitingToMoveBack() const;
 
@@ -48,10 +52,14 @@ public:
 
     void moveForward();
     void moveBackward(); // called by GameManager after cooldown
+    void setPosition(int newX, int newY);
 
     void destroy();
     bool isAlive() const;
 
+    void serialize(ByteWriter& out) const;
+    static Tank deserialize(ByteReader& in);
+
 private:
     int playerId;
     int x, y;
@@ -1,12 +1,17 @@
 #include <vector>
-#include <queue>
 #include <cmath>
-#include <limits>
 #include <utility>
 #include "Tank.h"
 #include "Board.h"
 #include <algorithm>
 #include "GameState.h"
+#include "TankAlgorithm.h"
+#include "BoardGeometry.h"
+#include "SearchEngine.h"
+#include "ThreatMap.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
 
 using Position = std::pair<int, int>;
 
@@ -14,10 +19,9 @@ using Position = std::pair<int, int>;
 static const Position dirOffsets[8] = {
     {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}};
 
-// Check in-bounds
-inline bool inBounds(const std::vector<std::vector<Cell>> &grid, const Position &p)
+inline CellContent contentAt(const Board &board, const Position &p)
 {
-    return p.second >= 0 && p.second < (int)grid.size() && p.first >= 0 && p.first < (int)grid[0].size();
+    return board.getCell(p.first, p.second).content;
 }
 
 // Convert two positions into one of 8 directions
@@ -54,152 +58,54 @@ Action rotateTowards(Direction current, Direction target)
     }
 }
 
-// A* pathfinding avoiding walls and mines
-std::vector<Position> findPath(
-    const std::vector<std::vector<Cell>> &grid,
-    Position start, Position goal)
-{
-    if (!inBounds(grid, start) || !inBounds(grid, goal))
-        return {};
-    int H = grid.size(), W = grid[0].size();
-    const double INF = std::numeric_limits<double>::infinity();
-    std::vector<std::vector<double>> gScore(H, std::vector<double>(W, INF));
-    std::vector<std::vector<Position>> parent(H, std::vector<Position>(W, {-1, -1}));
-
-    struct Node
-    {
-        double f;
-        Position pos;
-    };
-    auto cmp = [](auto &a, auto &b)
-    { return a.f > b.f; };
-    std::priority_queue<Node, std::vector<Node>, decltype(cmp)> open(cmp);
-
-    auto heur = [&](const Position &p)
-    {
-        double dx = goal.first - p.first;
-        double dy = goal.second - p.second;
-        return std::hypot(dx, dy);
-    };
-
-    gScore[start.second][start.first] = 0;
-    open.push({heur(start), start});
-
-    while (!open.empty())
-    {
-        auto [f, cur] = open.top();
-        open.pop();
-        if (cur == goal)
-            break;
-        if (f > gScore[cur.second][cur.first] + heur(cur))
-            continue;
-        for (int d = 0; d < 8; ++d)
-        {
-            Position nb{cur.first + dirOffsets[d].first,
-                        cur.second + dirOffsets[d].second};
-            if (!inBounds(grid, nb))
-                continue;
-            auto c = grid[nb.second][nb.first].content;
-            if (c == CellContent::WALL || c == CellContent::MINE)
-                continue;
-            double cost = (d % 2 == 0 ? 1.0 : 1.414);
-            double tent = gScore[cur.second][cur.first] + cost;
-            if (tent < gScore[nb.second][nb.first])
-            {
-                gScore[nb.second][nb.first] = tent;
-                parent[nb.second][nb.first] = cur;
-                open.push({tent + heur(nb), nb});
-            }
-        }
-    }
-
-    if (parent[goal.second][goal.first].first < 0)
-        return {};
-
-    std::vector<Position> path;
-    for (Position at = goal; at != start; at = parent[at.second][at.first])
-    {
-        path.push_back(at);
-    }
-    path.push_back(start);
-    std::reverse(path.begin(), path.end());
-    return path;
-}
-
-// Line-of-sight check with bounds
-bool hasLineOfSight(const std::vector<std::vector<Cell>> &grid,
+// Line-of-sight check along the 8 firing rays, following wrap-around
+bool hasLineOfSight(const Board &board,
                     Position from, Position to)
 {
     if (from == to)
         return true; // Shouldnt happen
 
-    int dx = to.first - from.first;
-    int dy = to.second - from.second;
-
-    for (Position dir : dirOffsets) // unit directions
-    {
-        int cross = dx * dir.second - dy * dir.first; // 2-D cross product
-        int dot = dx * dir.first + dy * dir.second;   // orientation test
-
-        if (cross == 0 && dot > 0) // on the same ray
-        {
-            int steps = std::max(std::abs(dx), std::abs(dy)); // |longest axis|
-
-            for (int s = 1; s <= steps; ++s)
-            {
-                Position p{from.first + dir.first * s,
-                           from.second + dir.second * s};
+    return lineOfSightDirection(board, from, to).has_value();
+}
 
-                if (!inBounds(grid, p) ||
-                    grid[p.second][p.first].content == CellContent::WALL)
-                    return false; // blocked
+GameView::GameView(const GameState& game, int tankIndex) : game(game), tankIndex(tankIndex) {}
 
-                if (p == to)
-                    return true; // reached target
-            }
-            return false; // ran out of steps without hitting 'to'
-        }
-    }
-    return false; // no matching direction found
+int GameView::getPlayer() const { return game.getTank(tankIndex).getPlayerId(); }
+const Board& GameView::getBoard() const { return game.getBoard(); }
+const Tank& GameView::getSelf() const { return game.getTank(tankIndex); }
+const Tank& GameView::getEnemy() const {
+    int enemy = game.nearestEnemy(tankIndex);
+    return game.getTank(enemy >= 0 ? enemy : tankIndex);
 }
+const ShellPool& GameView::getShells() const { return game.getShells(); }
+const ThreatMap& GameView::getThreats() const { return game.getThreats(); }
+int GameView::getStep() const { return game.getStepCount(); }
 
-
-Action decideTank1(
-    const std::vector<std::vector<Cell>> &grid,
-    Position pos1, Position pos2,
-    int tank1CoolDown, Direction &facing1)
+Action ChaseAlgorithm::decide(const GameView &view)
 {
-    if (tank1CoolDown == 0 && hasLineOfSight(grid, pos1, pos2)) {
-        Direction toT = directionTo(pos1, pos2);
-        if (facing1 == toT)       return Action::SHOOT;
-        else                      return rotateTowards(facing1, toT);
-    }
-
-    static std::vector<Position> cachedPath;
-    static int tick = 0;                     // counts calls to this function to modulate pathfinding calls
-
-    // Recompute only (a) on the first call, (b) every 4th call, or (c) if the goal changed
-    if (cachedPath.empty() || tick % 4 == 0 || cachedPath.back() != pos2) {
-        cachedPath = findPath(grid, pos1, pos2);
-        tick = 0;                            // restart the counter after a fresh path
+    const Board &board = view.getBoard();
+    Position pos1 = view.getSelf().getPosition();
+    Position pos2 = view.getEnemy().getPosition();
+    Direction facing1 = view.getSelf().getDirection();
+    int tank1CoolDown = view.getSelf().getShootCooldown();
+
+    if (tank1CoolDown == 0) {
+        if (auto toT = lineOfSightDirection(board, pos1, pos2)) {
+            if (facing1 == *toT)  return Action::SHOOT;
+            else                  return rotateTowards(facing1, *toT);
+        }
     }
-    ++tick;
 
-    // remove already-visited nodes so that cachedPath[0] == pos1 
-    while (!cachedPath.empty() && cachedPath.front() == pos1)
-        cachedPath.erase(cachedPath.begin());
-
-    if (cachedPath.size() >= 1) {            // ≥1 because we just stripped pos1
-        Position next = cachedPath.front(); 
-        Direction want = directionTo(pos1, next);
+    // The planner keeps its search tree between turns and only repairs the
+    // parts affected by the tanks moving or walls being destroyed
+    if (auto next = planner.nextStep(board, pos1, pos2)) {
+        Direction want = directionTowards(board, pos1, *next);
 
         if (facing1 != want)
             return rotateTowards(facing1, want);
 
         // if the cell immediately ahead already holds Tank 2, stop
-        bool willCollide =
-            pos1.first  + dirOffsets[static_cast<int>(facing1)].first  == pos2.first &&
-            pos1.second + dirOffsets[static_cast<int>(facing1)].second == pos2.second;
+        bool willCollide = wrappedNeighbor(board, pos1, facing1) == pos2;
 
         return willCollide ? Action::NONE : Action::MOVE_FORWARD;
     }
@@ -208,43 +114,45 @@ Action decideTank1(
 }
 
 
-Action decideTank2(
-    const std::vector<std::vector<Cell>> &grid,
-    Position pos2, Position pos1, Direction &facing2,
-    const std::vector<Shell> &shells)
-{
+// Turns of warning the reactive algorithm reacts to (a shell covers 2 cells a turn)
+static constexpr int kDodgeTurns = 3;
 
-    // Shell dodging
-    for (const auto &s : shells)
+Action ReactiveAlgorithm::decide(const GameView &view)
+{
+    const Board &board = view.getBoard();
+    const ThreatMap &threats = view.getThreats();
+    Position pos2 = view.getSelf().getPosition();
+    Position pos1 = view.getEnemy().getPosition();
+    Direction facing2 = view.getSelf().getDirection();
+
+    // Shell dodging: a shell reaches this cell within kDodgeTurns turns
+    int danger = threats.arrival(pos2.first, pos2.second);
+    if (danger != 0 && danger <= kDodgeTurns)
     {
-        Position sp{s.x, s.y};
-        for (int i = 1; i <= 5; ++i)
+        // Try sidestepping into a cell no shell reaches before this one
+        auto isSafe = [&](const Position &p)
         {
-            Position pred{sp.first + dirOffsets[static_cast<int>(s.dir)].first * i,
-                          sp.second + dirOffsets[static_cast<int>(s.dir)].second * i};
-            if (pred == pos2)
-            {
-                // Try sidestepping
-                int right = (static_cast<int>(facing2) + 2) % 8;
-                int left = (static_cast<int>(facing2) + 6) % 8;
-                Position rpos{pos2.first + dirOffsets[right].first, pos2.second + dirOffsets[right].second};
-                Position lpos{pos2.first + dirOffsets[left].first, pos2.second + dirOffsets[left].second};
-
-                if (inBounds(grid, rpos) && grid[rpos.second][rpos.first].content == CellContent::EMPTY)
-                {
-                    if (facing2 != static_cast<Direction>(right))
-                        return rotateTowards(facing2, static_cast<Direction>(right));
-                    return Action::MOVE_FORWARD;
-                }
-                if (inBounds(grid, lpos) && grid[lpos.second][lpos.first].content == CellContent::EMPTY)
-                {
-                    if (facing2 != static_cast<Direction>(left))
-                        return rotateTowards(facing2, static_cast<Direction>(left));
-                    return Action::MOVE_FORWARD;
-                }
-                return Action::ROTATE_LEFT_EIGHTH;
-            }
+            int arrival = threats.arrival(p.first, p.second);
+            return contentAt(board, p) == CellContent::EMPTY && (arrival == 0 || arrival > danger);
+        };
+        int right = (static_cast<int>(facing2) + 2) % 8;
+        int left = (static_cast<int>(facing2) + 6) % 8;
+        Position rpos = wrappedNeighbor(board, pos2, static_cast<Direction>(right));
+        Position lpos = wrappedNeighbor(board, pos2, static_cast<Direction>(left));
+
+        if (isSafe(rpos))
+        {
+            if (facing2 != static_cast<Direction>(right))
+                return rotateTowards(facing2, static_cast<Direction>(right));
+            return Action::MOVE_FORWARD;
         }
+        if (isSafe(lpos))
+        {
+            if (facing2 != static_cast<Direction>(left))
+                return rotateTowards(facing2, static_cast<Direction>(left));
+            return Action::MOVE_FORWARD;
+        }
+        return Action::ROTATE_LEFT_EIGHTH;
     }
 
     Direction from1 = directionTo(pos1, pos2);
@@ -255,15 +163,81 @@ Action decideTank2(
     if (facing2 != want)
         return rotateTowards(facing2, want);
 
-    Position step = dirOffsets[static_cast<int>(facing2)];
-    Position target{pos2.first + step.first, pos2.second + step.second};
-    if (inBounds(grid, target))
+    Position target = wrappedNeighbor(board, pos2, facing2);
+    if (contentAt(board, target) == CellContent::EMPTY)
+        return Action::MOVE_FORWARD;
+
+    return Action::NONE;
+}
+
+// Name -> factory, filled with the built-in algorithms on first use
+static std::map<std::string, TankAlgorithmFactory>& algorithmRegistry()
+{
+    static std::map<std::string, TankAlgorithmFactory> registry = {
+        {"chase", [](const AlgorithmSettings &) { return std::make_unique<ChaseAlgorithm>(); }},
+        {"reactive", [](const AlgorithmSettings &) { return std::make_unique<ReactiveAlgorithm>(); }},
+        {"search", [](const AlgorithmSettings &settings) {
+             SearchOptions options;
+             options.threads = settings.searchThreads;
+             options.timeBudgetMs = settings.searchMs;
+             return std::make_unique<SearchAlgorithm>(options);
+         }},
+    };
+    return registry;
+}
+
+// Batch workers create algorithms concurrently
+static std::mutex registryMutex;
+
+void registerTankAlgorithm(const std::string &name, TankAlgorithmFactory factory)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    algorithmRegistry()[name] = std::move(factory);
+}
+
+std::unique_ptr<TankAlgorithm> createTankAlgorithm(const std::string &name, const AlgorithmSettings &settings)
+{
+    TankAlgorithmFactory factory;
     {
-        auto c = grid[target.second][target.first].content;
-        if (c == CellContent::EMPTY)
-            return Action::MOVE_FORWARD;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = algorithmRegistry().find(name);
+        if (it == algorithmRegistry().end())
+            throw std::runtime_error("Unknown tank algorithm: " + name);
+        factory = it->second;
     }
+    return factory(settings);
+}
 
-    return Action::NONE;
+std::vector<std::string> tankAlgorithmNames()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<std::string> names;
+    for (const auto &entry : algorithmRegistry())
+        names.push_back(entry.first);
+    return names;
 }
 
+std::vector<std::unique_ptr<TankAlgorithm>> createTankAlgorithms(const GameState &game,
+                                                                 const std::string &player1Name,
+                                                                 const std::string &othersName,
+                                                                 const AlgorithmSettings &settings)
+{
+    std::vector<std::unique_ptr<TankAlgorithm>> algorithms;
+    for (const Tank &tank : game.getTanks())
+        algorithms.push_back(createTankAlgorithm(tank.getPlayerId() == 1 ? player1Name : othersName, settings));
+    return algorithms;
+}
+
+void decideActions(GameState &game, std::span<const std::unique_ptr<TankAlgorithm>> algorithms,
+                   std::vector<Action> &actions)
+{
+    actions.assign(game.getTankCount(), Action::NONE);
+    for (int i = 0; i < game.getTankCount(); ++i)
+    {
+        if (!game.getTank(i).isAlive())
+            continue;
+        StepPhase phase = game.getTank(i).getPlayerId() == 1 ? StepPhase::DECIDE_P1 : StepPhase::DECIDE_P2;
+        ProfileScope scope(game.getProfiler(), phase);
+        actions[i] = algorithms[i]->decide(GameView(game, i));
+    }
+}
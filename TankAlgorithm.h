@@ -1,17 +1,94 @@
 #pragma once
 
 #include "Tank.h"
+#include "IncrementalPlanner.h"
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class Board;
+class GameState;
+class ShellPool;
+class ThreatMap;
 
 using Position = std::pair<int, int>;
 
-Action decideTank1(
-    const std::vector<std::vector<Cell>> &grid,
-    Position pos1, Position pos2, int tank1CoolDown, Direction &facing1);
-Action decideTank2(
-    const std::vector<std::vector<Cell>> &grid,
-    Position pos2, Position pos1, Direction &facing2,
-    const std::vector<Shell> &shells);
+// Read-only view of the game from one tank's side, handed to an algorithm
+// every turn. It only refers to the live state (the flat board grid, the
+// tanks and the shell arrays), so building one costs nothing.
+class GameView {
+public:
+    // `tankIndex` indexes the game's tank table
+    GameView(const GameState& game, int tankIndex);
+
+    int getTankIndex() const { return tankIndex; }
+    int getPlayer() const;
+    const GameState& getGame() const { return game; }
+    const Board& getBoard() const;
+    const Tank& getSelf() const;
+    // Nearest living tank of another player; the tank itself if none is left
+    const Tank& getEnemy() const;
+    const ShellPool& getShells() const;
+    const ThreatMap& getThreats() const;
+    int getStep() const;
+
+private:
+    const GameState& game;
+    int tankIndex;
+};
+
+// A tank's decision maker. Each tank in each game gets its own instance, which
+// may keep whatever it likes between turns (path trees, search workers).
+class TankAlgorithm {
+public:
+    virtual ~TankAlgorithm() = default;
+    virtual Action decide(const GameView& view) = 0;
+};
+
+// Shoots when it has a clear line of fire, otherwise follows the shortest
+// path to the enemy. The path is repaired between turns, not recomputed.
+class ChaseAlgorithm : public TankAlgorithm {
+public:
+    Action decide(const GameView& view) override;
+
+private:
+    IncrementalPlanner planner;
+};
+
+// Sidesteps shells about to reach it, otherwise circles around the enemy
+class ReactiveAlgorithm : public TankAlgorithm {
+public:
+    Action decide(const GameView& view) override;
+};
+
+// Settings the registry passes to the algorithms it creates
+struct AlgorithmSettings {
+    int searchMs = 50;       // per-move budget of the search algorithm
+    int searchThreads = 0;   // its worker threads, 0 = one per hardware thread
+};
+
+using TankAlgorithmFactory = std::function<std::unique_ptr<TankAlgorithm>(const AlgorithmSettings&)>;
+
+// Algorithms by name. "chase", "reactive" and "search" are built in; more can
+// be added with registerTankAlgorithm. Unknown names throw std::runtime_error.
+void registerTankAlgorithm(const std::string& name, TankAlgorithmFactory factory);
+std::unique_ptr<TankAlgorithm> createTankAlgorithm(const std::string& name,
+                                                   const AlgorithmSettings& settings = {});
+std::vector<std::string> tankAlgorithmNames();
+
+// One algorithm per tank of `game`: `player1Name` for the tanks of player 1,
+// `othersName` for the tanks of every other player
+std::vector<std::unique_ptr<TankAlgorithm>> createTankAlgorithms(const GameState& game,
+                                                                 const std::string& player1Name,
+                                                                 const std::string& othersName,
+                                                                 const AlgorithmSettings& settings = {});
+// Asks every living tank's algorithm for its action (NONE for destroyed
+// tanks), timing the decisions in the game's profiler
+void decideActions(GameState& game, std::span<const std::unique_ptr<TankAlgorithm>> algorithms,
+                   std::vector<Action>& actions);
 
 bool hasLineOfSight(
-    const std::vector<std::vector<Cell>> &grid,
-    Position from, Position to);
\ No newline at end of file
+    const Board &board,
+    Position from, Position to);
@@ -0,0 +1,33 @@
+#include "ThreatMap.h"
+#include "Board.h"
+#include "BoardGeometry.h"
+#include "ShellPool.h"
+#include <algorithm>
+
+void ThreatMap::build(const Board& board, const ShellPool& shells) {
+    width = board.getWidth();
+    if (stamps.size() != (std::size_t)board.getCellCount()) {
+        stamps.assign(board.getCellCount(), 0);
+        turns.assign(board.getCellCount(), 0);
+        stamp = 0;
+    }
+    if (++stamp == 0) {
+        // Stamp wrapped around: old stamps could look current again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+
+    for (std::size_t i = 0; i < shells.size(); ++i) {
+        int x = shells.x(i), y = shells.y(i);
+        for (int sub = 0; sub < 2 * kHorizon; ++sub) {
+            stepWrapped(board, x, y, shells.dir(i));
+            int cell = board.index(x, y);
+            if (board.getCell(cell).content == CellContent::WALL) break;
+            auto turn = static_cast<std::uint8_t>(sub / 2 + 1);
+            if (stamps[cell] != stamp || turns[cell] > turn) {
+                stamps[cell] = stamp;
+                turns[cell] = turn;
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Board;
+class ShellPool;
+
+// For every cell, the first turn in which a shell in flight will enter it.
+//
+// Each shell's ray is marched once, two cells per turn as in GameState::step,
+// wrapping at the edges and stopping at the first wall (an intact border wall
+// stops a wrapping shell just the same). Tanks are not treated as cover since
+// they move. Cells are stamped rather than cleared, so a rebuild only touches
+// the cells the rays cross and lookups are a single compare.
+class ThreatMap {
+public:
+    // Turns looked ahead; later arrivals are not recorded
+    static constexpr int kHorizon = 8;
+
+    void build(const Board& board, const ShellPool& shells);
+
+    // Turn (1 = the coming step) in which a shell first enters the cell, or 0
+    // if none does within kHorizon turns. Tanks move before shells, so a tank
+    // that ends its move on a cell with arrival 1 is hit in that step.
+    int arrival(int cell) const { return stamps[cell] == stamp ? turns[cell] : 0; }
+    int arrival(int x, int y) const { return arrival(y * width + x); }
+
+private:
+    std::vector<std::uint32_t> stamps;   // turns[c] is valid when stamps[c] == stamp
+    std::vector<std::uint8_t> turns;
+    std::uint32_t stamp = 0;
+    int width = 0;
+};
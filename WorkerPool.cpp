@@ -0,0 +1,52 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int threads) {
+    for (int t = 1; t < threads; ++t) workers.emplace_back([this] { workerLoop(); });
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void WorkerPool::run(int count, const std::function<void(int)>& job) {
+    if (workers.empty() || count <= 1) {
+        for (int i = 0; i < count; ++i) job(i);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &job;
+        taskCount = count;
+        nextTask = 0;
+        busyWorkers = (int)workers.size();
+        ++jobId;
+    }
+    wake.notify_all();
+    runTasks();
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busyWorkers == 0; });
+}
+
+void WorkerPool::workerLoop() {
+    std::uint64_t seenJob = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || jobId != seenJob; });
+            if (stopping) return;
+            seenJob = jobId;
+        }
+        runTasks();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) done.notify_one();
+    }
+}
+
+void WorkerPool::runTasks() {
+    for (int i = nextTask++; i < taskCount; i = nextTask++) (*task)(i);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads for the parallel loops inside one game step. run()
+// hands out task numbers to the workers and the calling thread alike and
+// returns once every task has finished, so the threads are started once and
+// a loop costs two wake-ups rather than a thread launch.
+class WorkerPool {
+public:
+    // `threads` counts the calling thread, so 1 starts no workers
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int getThreadCount() const { return (int)workers.size() + 1; }
+
+    // Calls task(0) ... task(count - 1), each exactly once, in no particular
+    // order or thread. Tasks must not throw.
+    void run(int count, const std::function<void(int)>& task);
+
+private:
+    std::vector<std::thread> workers;
+
+    // Current loop, published under `mutex`
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t jobId = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+    const std::function<void(int)>* task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{0};
+
+    void workerLoop();
+    void runTasks();
+};
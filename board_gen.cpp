@@ -0,0 +1,81 @@
+#include "BoardGenerator.h"
+#include <iostream>
+#include <string>
+
+// Writes a generated board as a text board, a binary board, or both
+
+void print_usage() {
+    std::cerr << "Usage: board_gen --width W --height H [--text <file>] [--binary <file>]\n"
+              << "                 [--layout arena|maze] [--walls P] [--loops P] [--mines P] [--border]\n"
+              << "                 [--tanks spread|corners|random] [--players N] [--tanks-per-player N]\n"
+              << "                 [--seed N]\n"
+              << "Sizes from " << BoardSpec::kMinSize << " to " << BoardSpec::kMaxSize
+              << "; P is a percentage. At least one of --text and --binary is required.\n";
+}
+
+bool parse_layout(const std::string& name, BoardLayout& layout) {
+    if (name == "arena") layout = BoardLayout::ARENA;
+    else if (name == "maze") layout = BoardLayout::MAZE;
+    else return false;
+    return true;
+}
+
+bool parse_tanks(const std::string& name, TankPlacement& tanks) {
+    if (name == "spread") tanks = TankPlacement::SPREAD;
+    else if (name == "corners") tanks = TankPlacement::CORNERS;
+    else if (name == "random") tanks = TankPlacement::RANDOM;
+    else return false;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BoardSpec spec;
+    std::string textPath, binaryPath;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string opt = argv[a];
+            if (opt == "--border") {
+                spec.borderWalls = true;
+                continue;
+            }
+            if (a + 1 >= argc) {
+                print_usage();
+                return 1;
+            }
+            std::string value = argv[++a];
+            if (opt == "--width") spec.width = std::stoi(value);
+            else if (opt == "--height") spec.height = std::stoi(value);
+            else if (opt == "--walls") spec.wallPercent = std::stoi(value);
+            else if (opt == "--loops") spec.loopPercent = std::stoi(value);
+            else if (opt == "--mines") spec.minePercent = std::stoi(value);
+            else if (opt == "--players") spec.players = std::stoi(value);
+            else if (opt == "--tanks-per-player") spec.tanksPerPlayer = std::stoi(value);
+            else if (opt == "--seed") spec.seed = std::stoull(value);
+            else if (opt == "--text") textPath = value;
+            else if (opt == "--binary") binaryPath = value;
+            else if (opt == "--layout" && parse_layout(value, spec.layout)) continue;
+            else if (opt == "--tanks" && parse_tanks(value, spec.tanks)) continue;
+            else {
+                print_usage();
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {   // std::stoi and friends on a bad number
+        print_usage();
+        return 1;
+    }
+    if (textPath.empty() && binaryPath.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    try {
+        Board board = generateBoard(spec);
+        if (!textPath.empty()) board.saveText(textPath);
+        if (!binaryPath.empty()) board.saveBinary(binaryPath);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
@@ -1,6 +1,7 @@
 #include "Board.h"
 #include "GameState.h"
 #include "Tank.h"
+#include <algorithm>
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,6 +9,9 @@
 #include <termios.h>
 #include <string.h>
 #include "TankAlgorithm.h"
+#include "BatchRunner.h"
+#include "Replay.h"
+#include <memory>
 
 
 void clear_screen() {
@@ -30,73 +34,252 @@ char get_key() {
     return ch;
 }
 
+void print_usage() {
+    std::string names;
+    for (const std::string& name : tankAlgorithmNames()) names += (names.empty() ? "" : "|") + name;
+    std::cerr << "Usage: tanks_game <board_file> [--log-format text|jsonl] [--save-replay <file>]\n"
+              << "                  [--p1 <algorithm>] [--p2 <algorithm>] [--search-ms <ms>] [--step-threads N]\n"
+              << "       tanks_game --batch <board_dir|manifest> [--threads N] [--max-steps N] [--summary <file>]\n"
+              << "                  [--log-format text|jsonl] [--p1 <algorithm>] [--p2 <algorithm>] [--search-ms <ms>]\n"
+              << "                  [--profile <file>]\n"
+              << "       tanks_game --convert <text_board> <binary_board>\n"
+              << "       tanks_game --view <replay_file>\n"
+              << "Algorithms: " << names << " (default: --p1 chase --p2 reactive)\n";
+}
+
+int run_convert_mode(int argc, char* argv[]) {
+    if (argc != 4) {
+        print_usage();
+        return 1;
+    }
+    try {
+        Board board(argv[2]);
+        board.saveBinary(argv[3]);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
+
+bool parse_log_format(const std::string& name, LogFormat& format) {
+    if (name == "text") format = LogFormat::TEXT;
+    else if (name == "jsonl") format = LogFormat::JSONL;
+    else return false;
+    return true;
+}
+
+// --search-ms only tunes the "search" algorithm, so giving it when no player
+// uses search is reported rather than silently ignored
+bool check_search_ms(bool given, const std::string& player1, const std::string& player2) {
+    if (!given || player1 == "search" || player2 == "search") return true;
+    std::cerr << "Error: --search-ms needs --p1 search or --p2 search\n";
+    return false;
+}
+
+int run_batch_mode(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage();
+        return 1;
+    }
+    BatchOptions options;
+    bool searchMsGiven = false;
+    for (int a = 3; a < argc; ++a) {
+        std::string opt = argv[a];
+        if (a + 1 >= argc) {
+            print_usage();
+            return 1;
+        }
+        if (opt == "--threads" && (options.threads = std::atoi(argv[++a])) > 0) continue;
+        else if (opt == "--max-steps" && (options.maxSteps = std::atoi(argv[++a])) > 0) continue;
+        else if (opt == "--summary") options.summaryPath = argv[++a];
+        else if (opt == "--p1") options.player1 = argv[++a];
+        else if (opt == "--p2") options.player2 = argv[++a];
+        else if (opt == "--search-ms" && (options.searchMs = std::atoi(argv[++a])) > 0) searchMsGiven = true;
+        else if (opt == "--profile") options.profilePath = argv[++a];
+        else if (opt == "--log-format" && parse_log_format(argv[++a], options.logFormat)) continue;
+        else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (!check_search_ms(searchMsGiven, options.player1, options.player2)) return 1;
+
+    try {
+        return runBatch(argv[2], options);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
+
+// Text shown for the player's current step: the actions that led to it, a
+// few tank facts and the board
+std::string render_frame(const ReplaySource& replay, const ReplayPlayer& player) {
+    const GameState& game = player.getGame();
+    int step = player.getStep();
+    if (step == 0) return "Start\n" + game.render();
+
+    std::vector<Action> actions;
+    replay.getActions(step - 1, actions);
+    std::string s = " Just Taken actions:";
+    for (Action action : actions) {
+        s += ' ';
+        s += toString(action);
+    }
+    s += "\n";
+    for (int t = 0; t < game.getTankCount(); ++t) {
+        const Tank& tank = game.getTank(t);
+        s += game.tankLabel(t);
+        s += ':';
+        if (!tank.isAlive()) {
+            s += " destroyed\n";
+            continue;
+        }
+        auto [x, y] = tank.getPosition();
+        s += " pos ";
+        s += std::to_string(x);
+        s += ' ';
+        s += std::to_string(y);
+        s += " cooldown ";
+        s += std::to_string(tank.getShootCooldown());
+        int enemy = game.nearestEnemy(t);
+        if (enemy >= 0) {
+            bool lineOfFire = hasLineOfSight(player.getBoard(), tank.getPosition(), game.getTank(enemy).getPosition());
+            s += " LOF to ";
+            s += game.tankLabel(enemy);
+            s += lineOfFire ? " true" : " false";
+        }
+        s += "\n";
+    }
+    s += game.render();
+    return s;
+}
+
+// Reads a turn number typed at the prompt, or -1 if nothing was entered
+int read_turn_number() {
+    cout << "Go to turn: " << std::flush;
+    std::string digits;
+    while (true) {
+        char ch = get_key();
+        if (ch == '\n' || ch == '\r') break;
+        if (ch >= '0' && ch <= '9' && digits.size() < 9) {
+            digits += ch;
+            cout << ch << std::flush;
+        } else if ((ch == 127 || ch == '\b') && !digits.empty()) {
+            digits.pop_back();
+            cout << "\b \b" << std::flush;
+        }
+    }
+    return digits.empty() ? -1 : std::stoi(digits);
+}
+
+// Arrow-key viewer over the steps of a replay; frames are rebuilt as they are shown
+void run_viewer(const ReplaySource& replay) {
+    ReplayPlayer player(replay);
+    int index = 0;
+
+    while (1) {
+        clear_screen();
+        player.seek(index);
+        cout << "\n Turn #" << index << "\n" << render_frame(replay, player);
+        cout << "\n[← or → to navigate, g to go to a turn, q to quit]\n";
+
+        char ch = get_key();
+
+        if (ch == 'q') break;
+        else if (ch == 'g') {
+            int turn = read_turn_number();
+            if (turn >= 0) index = std::min(turn, replay.getStepCount());
+        }
+        else if (ch == '\033') { // Escape
+            get_key(); 
+            ch = get_key();
+            if (ch == 'C') { // Right arrow
+                if (index < replay.getStepCount()) index++;
+            } else if (ch == 'D') { // Left arrow
+                if (index > 0) index--;
+            }
+        }
+    }
+
+    clear_screen();
+}
+
+int run_view_mode(int argc, char* argv[]) {
+    if (argc != 3) {
+        print_usage();
+        return 1;
+    }
+    try {
+        ReplayFile replay(argv[2]);
+        run_viewer(replay);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: tanks_game <board_file>\n";
+        print_usage();
         return 1;
     }
+    if (std::string(argv[1]) == "--batch") {
+        return run_batch_mode(argc, argv);
+    }
+    if (std::string(argv[1]) == "--convert") {
+        return run_convert_mode(argc, argv);
+    }
+    if (std::string(argv[1]) == "--view") {
+        return run_view_mode(argc, argv);
+    }
+    LogFormat logFormat = LogFormat::TEXT;
+    std::string replayPath;
+    std::string player1 = "chase", player2 = "reactive";
+    AlgorithmSettings settings;
+    int stepThreads = 1;
+    bool searchMsGiven = false;
+    for (int a = 2; a < argc; a += 2) {
+        std::string opt = argv[a];
+        bool valid = a + 1 < argc;
+        if (valid && opt == "--log-format") valid = parse_log_format(argv[a + 1], logFormat);
+        else if (valid && opt == "--save-replay") replayPath = argv[a + 1];
+        else if (valid && opt == "--p1") player1 = argv[a + 1];
+        else if (valid && opt == "--p2") player2 = argv[a + 1];
+        else if (valid && opt == "--search-ms") valid = searchMsGiven = (settings.searchMs = std::atoi(argv[a + 1])) > 0;
+        else if (valid && opt == "--step-threads") valid = (stepThreads = std::atoi(argv[a + 1])) > 0;
+        else valid = false;
+        if (!valid) {
+            print_usage();
+            return 1;
+        }
+    }
+    if (!check_search_ms(searchMsGiven, player1, player2)) return 1;
 
     try {
         Board board(argv[1]);
-        GameState game(board, argv[1]);
-        board.print(game.tank1.getDirection(), game.tank2.getDirection());
-        std::vector<std::string> moves;
+        GameState game(board, argv[1], logFormat);
+        game.setStepThreads(stepThreads);
+        auto algorithms = createTankAlgorithms(game, player1, player2, settings);
+        Replay replay(board);
+        std::vector<Action> actions;
 
         int i =1;
-        moves.push_back("Start\n" + game.render());
         while (!game.isGameOver() && i<=200) {
-            std::string s = "";
-            auto tank1Position = game.getTank1Position();
-            auto tank2Position = game.getTank2Position();
-            auto tank1Direction = game.tank1.getDirection();
-            auto tank2Direction = game.tank2.getDirection();
-            auto tank1Cooldown = game.tank1.shootCooldown;
-
-            std::string msg;
-            Action p1 = decideTank1(board.grid, tank1Position, tank2Position, tank1Cooldown, tank1Direction);
-            Action p2 = decideTank2(board.grid, tank2Position, tank1Position, tank2Direction,game.shells);
-            game.step(p1, p2);
-            
-            tank1Position = game.getTank1Position();
-            tank2Position = game.getTank2Position();
-            tank1Direction = game.tank1.getDirection();
-            tank2Direction = game.tank2.getDirection();
-            tank1Cooldown = game.tank1.shootCooldown;
-
-            s += " Just Taken actions: " + toString(p1) + " " + toString(p2) + "\n";
-            s += "newTanks1pos:" + std::to_string(tank1Position.first) + " " + std::to_string(tank1Position.second) + "\n";
-            s += "Tanks2pos:" + std::to_string(tank2Position.first) + " " + std::to_string(tank2Position.second) + "\n";
-            s += "Tank1cooldown:" + std::to_string(tank1Cooldown) + "\n";
-            s += "Tank1LOF:" + std::string(hasLineOfSight(board.grid, tank1Position, tank2Position) ? "true" : "false") + "\n";
-
-            s +=game.render();
-            moves.push_back(s);
+            decideActions(game, algorithms, actions);
+            game.step(actions);
+            replay.record(actions);
+
             cout << "Turn "  << i << " complete\n";
             i++;
         }
     
-        size_t index = 0;
-    
-        while (1) {
-            clear_screen();
-            cout << "\n Turn #" << index << "\n" <<  moves[index];
-            cout << "\n[← or → to navigate, q to quit]\n";
-    
-            char ch = get_key();
-    
-            if (ch == 'q') break;
-            else if (ch == '\033') { // Escape
-                get_key(); 
-                ch = get_key();
-                if (ch == 'C') { // Right arrow
-                    if (index < moves.size() - 1) index++;
-                } else if (ch == 'D') { // Left arrow
-                    if (index > 0) index--;
-                }
-            }
-        }
-    
+        if (!replayPath.empty()) replay.save(replayPath);
+        run_viewer(replay);
         clear_screen();
+        if constexpr (kProfilingEnabled) game.getProfiler().report(std::cerr);
         return 0;
         
     } catch (const std::exception& e) {
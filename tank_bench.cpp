@@ -0,0 +1,492 @@
+#include "Board.h"
+#include "BoardGenerator.h"
+#include "BoardGeometry.h"
+#include "ByteStream.h"
+#include "GameState.h"
+#include "IncrementalPlanner.h"
+#include "PathFinder.h"
+#include "TankAlgorithm.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Micro-benchmarks of the game core. Each benchmark is timed over a growing
+// number of iterations until it runs for at least --min-time seconds; the
+// results are printed as a table and, with --json, written in the same JSON
+// layout as Google Benchmark so runs of two versions can be compared with its
+// tools/compare.py. --check instead runs the consistency checks below, which
+// compare the optimised code paths against the simple ones.
+
+#ifndef TANK_SOURCE_DIR
+#define TANK_SOURCE_DIR "."
+#endif
+
+struct BenchResult {
+    std::string name;
+    long long iterations = 0;
+    double nsPerIteration = 0;
+    double itemsPerSecond = 0;   // 0 when the benchmark counts no items
+};
+
+struct BenchOptions {
+    std::string filter;          // run only benchmarks whose name contains this
+    double minTime = 0.5;        // seconds per benchmark
+    std::string jsonPath;
+    std::string boardDir = TANK_SOURCE_DIR;
+};
+
+// Keeps results alive so the optimizer can't drop the work producing them
+static volatile std::uint64_t benchSink;
+static void keep(std::uint64_t value) { benchSink = benchSink + value; }
+
+// Runs `body(iterations)` and returns the number of items it processed
+using BenchBody = std::function<long long(long long iterations)>;
+
+// splitmix64, so the query pairs and shells are the same on every run
+static std::uint64_t next_random(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// A board file the benchmarks load: one of the sample inputs or a generated one
+struct BenchBoard {
+    std::string label;
+    std::string path;
+};
+
+static BenchResult run_benchmark(const std::string& name, const BenchBody& body, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    long long iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        long long items = body(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minTime || iterations >= (1LL << 40)) {
+            BenchResult result;
+            result.name = name;
+            result.iterations = iterations;
+            result.nsPerIteration = seconds * 1e9 / (double)iterations;
+            result.itemsPerSecond = items > 0 ? (double)items / seconds : 0;
+            return result;
+        }
+        // Aim a bit past the minimum time so the next run is usually the last
+        double scale = seconds > 0 ? minTime * 1.4 / seconds : 10.0;
+        iterations = std::max(iterations + 1, (long long)((double)iterations * std::min(scale, 10.0)));
+    }
+}
+
+// Pairs of open cells to query between, the same for every run
+static std::vector<std::pair<Position, Position>> open_cell_pairs(const Board& board, int count) {
+    std::vector<Position> open;
+    for (int y = 0; y < board.getHeight(); ++y)
+        for (int x = 0; x < board.getWidth(); ++x)
+            if (board.getCell(x, y).content != CellContent::WALL) open.push_back({x, y});
+    std::vector<std::pair<Position, Position>> pairs;
+    std::uint64_t rng = 42;
+    for (int i = 0; i < count && open.size() > 1; ++i)
+        pairs.push_back({open[next_random(rng) % open.size()], open[next_random(rng) % open.size()]});
+    return pairs;
+}
+
+static void register_board_benchmarks(std::vector<std::pair<std::string, BenchBody>>& benches,
+                                      const BenchBoard& bb, const std::string& binaryPath) {
+    benches.push_back({"parse_text/" + bb.label, [path = bb.path](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            Board board(path);
+            keep(board.getCellCount());
+        }
+        return 0LL;
+    }});
+    benches.push_back({"load_binary/" + bb.label, [binaryPath](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            Board board(binaryPath);
+            keep(board.getCellCount());
+        }
+        return 0LL;
+    }});
+    benches.push_back({"print/" + bb.label, [path = bb.path](long long n) {
+        Board board(path);
+        GameState game(board);
+        for (long long i = 0; i < n; ++i) keep(board.print(game.getTanks()).size());
+        return 0LL;
+    }});
+    benches.push_back({"line_of_sight/" + bb.label, [path = bb.path](long long n) {
+        Board board(path);
+        auto pairs = open_cell_pairs(board, 1024);
+        if (pairs.empty()) return 0LL;
+        for (long long i = 0; i < n; ++i) {
+            const auto& [from, to] = pairs[i % pairs.size()];
+            keep(hasLineOfSight(board, from, to));
+        }
+        return n;
+    }});
+    benches.push_back({"find_path/" + bb.label, [path = bb.path](long long n) {
+        Board board(path);
+        auto pairs = open_cell_pairs(board, 256);
+        if (pairs.empty()) return 0LL;
+        PathFinder finder;
+        std::vector<Position> route;
+        for (long long i = 0; i < n; ++i) {
+            const auto& [from, to] = pairs[i % pairs.size()];
+            finder.findPath(board, from, to, route);
+            keep(route.size());
+        }
+        return n;
+    }});
+}
+
+// `shells` shells in random open cells and directions, then GameState::step
+// with every tank idle, its shell phases on `threads` threads. Every 8 steps
+// the game is rolled back so the shell count stays close to the requested one.
+static long long bench_step(const std::string& path, int shellCount, int threads, long long n) {
+    Board board(path);
+    GameState game(board);
+    game.setStepThreads(threads);
+    GameState::Snapshot start = game.snapshot();
+    auto pairs = open_cell_pairs(board, shellCount);
+    std::uint64_t rng = 7;
+    for (const auto& pair : pairs)
+        start.shells.push(pair.first.first, pair.first.second, static_cast<Direction>(next_random(rng) % 8));
+    game.restore(start);
+    std::vector<Action> idle(game.getTankCount(), Action::NONE);
+
+    long long steps = 0;
+    while (steps < n) {
+        GameState::Checkpoint checkpoint = game.checkpoint();
+        for (int s = 0; s < 8 && steps < n; ++s, ++steps) game.step(idle);
+        game.rollback(checkpoint);
+    }
+    return steps;
+}
+
+// Whole games of the default algorithms (chase against reactive), up to
+// `maxSteps` steps each; items are the steps played
+static long long bench_game(const std::string& path, int maxSteps, long long n) {
+    long long steps = 0;
+    for (long long i = 0; i < n; ++i) {
+        Board board(path);
+        GameState game(board);
+        auto algorithms = createTankAlgorithms(game, "chase", "reactive");
+        std::vector<Action> actions;
+        while (!game.isGameOver() && game.getStepCount() < maxSteps) {
+            decideActions(game, algorithms, actions);
+            game.step(actions);
+        }
+        steps += game.getStepCount();
+    }
+    return steps;
+}
+
+// Cost of a path in PathFinder's octile units
+static int path_cost(const Board& board, const std::vector<Position>& path) {
+    int cost = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        bool diagonal = wrappedDelta(path[i - 1].first, path[i].first, board.getWidth()) != 0 &&
+                        wrappedDelta(path[i - 1].second, path[i].second, board.getHeight()) != 0;
+        cost += diagonal ? PathFinder::kDiagonalCost : PathFinder::kStraightCost;
+    }
+    return cost;
+}
+
+// The chase planner (IncrementalPlanner) against a fresh PathFinder search
+// while walls are removed and added, the goal moves and the start follows
+// the planned path. Returns the number of rounds whose costs differ.
+static int check_planner(const std::string& path) {
+    Board board(path);
+    int width = board.getWidth(), height = board.getHeight();
+    std::uint64_t rng = 11;
+    auto randomCell = [&] {
+        return Position{(int)(next_random(rng) % width), (int)(next_random(rng) % height)};
+    };
+    auto randomOpenCell = [&] {
+        for (int tries = 0; tries < 1000; ++tries) {
+            Position p = randomCell();
+            if (!blocksMovement(board.getCell(p.first, p.second).content)) return p;
+        }
+        return Position{-1, -1};
+    };
+    Position start = randomOpenCell(), goal = randomOpenCell();
+    if (start.first < 0 || goal.first < 0) return 0;
+
+    IncrementalPlanner planner;
+    PathFinder finder;
+    std::vector<Position> expected, planned;
+    int mismatches = 0;
+    for (int round = 0; round < 500; ++round) {
+        std::optional<Position> step = planner.nextStep(board, start, goal);
+        finder.findPath(board, start, goal, expected);
+        if (step) planner.currentPath(planned);
+        bool reachable = expected.size() > 1;
+        if (step.has_value() != reachable || (step && path_cost(board, planned) != path_cost(board, expected)))
+            ++mismatches;
+
+        // Terrain edits land next to the current path half of the time
+        Position p = randomCell();
+        if (reachable && next_random(rng) % 2)
+            p = wrappedNeighbor(board, expected[next_random(rng) % expected.size()],
+                                static_cast<Direction>(next_random(rng) % 8));
+        CellContent content = board.getCell(p.first, p.second).content;
+        switch (next_random(rng) % 4) {
+            case 0:   // the goal steps to a neighbour, or jumps when it's boxed in or reached
+                goal = wrappedNeighbor(board, goal, static_cast<Direction>(next_random(rng) % 8));
+                if (blocksMovement(board.getCell(goal.first, goal.second).content) || goal == start)
+                    goal = randomOpenCell();
+                break;
+            case 1:
+                if (content == CellContent::WALL) board.setCell(p.first, p.second, CellContent::EMPTY);
+                break;
+            case 2:
+                if (content == CellContent::EMPTY && p != start && p != goal)
+                    board.setCell(p.first, p.second, CellContent::WALL);
+                break;
+            default:
+                if (step) start = *step;
+                if (start == goal) goal = randomOpenCell();
+                break;
+        }
+        if (goal.first < 0) break;
+    }
+    return mismatches;
+}
+
+// GameState::step with striped shell phases against the same steps on one
+// thread. Each round seeds `shellCount` fresh shells into the starting
+// snapshot, then plays two steps of random actions (fewer if the shells end
+// the game) and compares the tanks, shells and board cells after each.
+// Returns the number of steps that differ.
+static int check_striped_step(const std::string& path, int shellCount, int threads) {
+    Board serialBoard(path), stripedBoard(path);
+    GameState serial(serialBoard), striped(stripedBoard);
+    striped.setStepThreads(threads);
+    GameState::Snapshot base = serial.snapshot();
+    std::vector<Position> cells;
+    for (const auto& pair : open_cell_pairs(serialBoard, shellCount)) cells.push_back(pair.first);
+
+    std::uint64_t rng = 7;
+    std::vector<Action> actions(serial.getTankCount());
+    int mismatches = 0;
+    for (int round = 0; round < 16; ++round) {
+        GameState::Snapshot start = base;
+        for (const Position& cell : cells)
+            start.shells.push(cell.first, cell.second, static_cast<Direction>(next_random(rng) % 8));
+        serial.restore(start);
+        striped.restore(start);
+        for (int step = 0; step < 2 && !serial.isGameOver(); ++step) {
+            for (Action& action : actions) action = static_cast<Action>(next_random(rng) % 8);
+            serial.step(actions);
+            striped.step(actions);
+            ByteWriter serialState, stripedState;
+            serialBoard.serialize(serialState);
+            serial.serialize(serialState);
+            stripedBoard.serialize(stripedState);
+            striped.serialize(stripedState);
+            if (serialState.data() != stripedState.data()) ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+static std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void write_json(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Failed to open benchmark output: " + path);
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"tank_bench\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n  \"benchmarks\": [\n";
+    out << std::setprecision(10);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\n"
+            << "      \"name\": \"" << json_escape(r.name) << "\",\n"
+            << "      \"run_name\": \"" << json_escape(r.name) << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"real_time\": " << r.nsPerIteration << ",\n"
+            << "      \"cpu_time\": " << r.nsPerIteration << ",\n";
+        if (r.itemsPerSecond > 0) out << "      \"items_per_second\": " << r.itemsPerSecond << ",\n";
+        out << "      \"time_unit\": \"ns\"\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void print_usage() {
+    std::cerr << "Usage: tank_bench [--filter <text>] [--min-time <seconds>] [--json <file>] [--boards <dir>]\n"
+              << "       tank_bench --list\n"
+              << "       tank_bench --check [--filter <text>] [--boards <dir>]\n";
+}
+
+// Runs the consistency checks whose names contain `filter`; false if any failed
+static bool run_checks(const std::vector<BenchBoard>& boards, const std::string& filter) {
+    std::vector<std::pair<std::string, std::function<int()>>> checks;
+    for (const BenchBoard& bb : boards)
+        checks.push_back({"planner/" + bb.label, [path = bb.path] { return check_planner(path); }});
+    // Enough shells for striping, on at least two threads even on one core
+    int threads = std::max(2, (int)std::thread::hardware_concurrency());
+    for (const BenchBoard& bb : boards) {
+        if (bb.label.rfind("256x256", 0) != 0) continue;
+        checks.push_back({"striped_step/" + bb.label + "/threads:" + std::to_string(threads),
+                          [path = bb.path, threads] { return check_striped_step(path, 16384, threads); }});
+    }
+
+    bool passed = true;
+    for (const auto& [name, check] : checks) {
+        if (name.find(filter) == std::string::npos) continue;
+        int mismatches = check();
+        std::cout << std::left << std::setw(48) << name
+                  << (mismatches == 0 ? "ok" : std::to_string(mismatches) + " mismatches") << '\n';
+        passed = passed && mismatches == 0;
+    }
+    return passed;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    bool listOnly = false;
+    bool checkOnly = false;
+    for (int a = 1; a < argc; ++a) {
+        std::string opt = argv[a];
+        if (opt == "--list") {
+            listOnly = true;
+            continue;
+        }
+        if (opt == "--check") {
+            checkOnly = true;
+            continue;
+        }
+        if (a + 1 >= argc) {
+            print_usage();
+            return 1;
+        }
+        if (opt == "--filter") options.filter = argv[++a];
+        else if (opt == "--min-time") options.minTime = std::stod(argv[++a]);
+        else if (opt == "--json") options.jsonPath = argv[++a];
+        else if (opt == "--boards") options.boardDir = argv[++a];
+        else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    // Generated boards and their binary copies live in a scratch directory
+    namespace fs = std::filesystem;
+    fs::path scratch = fs::temp_directory_path() / ("tank_bench_" + std::to_string(getpid()));
+    fs::create_directories(scratch);
+
+    std::vector<BenchBoard> boards;
+    for (const char* name : {"input_a", "input_b", "input_c"}) {
+        fs::path path = fs::path(options.boardDir) / (std::string(name) + ".txt");
+        if (fs::exists(path)) boards.push_back({name, path.string()});
+        else std::cerr << "Skipping missing sample board " << path << '\n';
+    }
+    std::vector<std::pair<std::string, BenchBody>> benches;
+    try {
+        for (int size : {16, 64, 256}) {
+            for (int walls : {10, 30}) {
+                BoardSpec spec;
+                spec.width = spec.height = size;
+                spec.wallPercent = walls;
+                spec.minePercent = 0;
+                spec.seed = (std::uint64_t)size * 100 + walls;
+                std::string label = std::to_string(size) + "x" + std::to_string(size) + "/walls:" + std::to_string(walls);
+                fs::path path = scratch / ("gen_" + std::to_string(size) + "_" + std::to_string(walls) + ".txt");
+                generateBoard(spec).saveText(path.string());
+                boards.push_back({label, path.string()});
+            }
+        }
+        if (checkOnly) {
+            bool passed = run_checks(boards, options.filter);
+            fs::remove_all(scratch);
+            return passed ? 0 : 1;
+        }
+        for (size_t b = 0; b < boards.size(); ++b) {
+            std::string binaryPath = (scratch / ("board_" + std::to_string(b) + ".tnkb")).string();
+            Board(boards[b].path).saveBinary(binaryPath);
+            register_board_benchmarks(benches, boards[b], binaryPath);
+        }
+        for (const BenchBoard& bb : boards) {
+            for (int shells : {0, 64, 1024}) {
+                benches.push_back({"step/" + bb.label + "/shells:" + std::to_string(shells),
+                                   [path = bb.path, shells](long long n) { return bench_step(path, shells, 1, n); }});
+            }
+            // Striped steps only pay off with many shells, so only on the big boards
+            if (bb.label.rfind("256x256", 0) == 0) {
+                std::vector<int> threadCounts = {1};
+                if (std::thread::hardware_concurrency() > 1) threadCounts.push_back((int)std::thread::hardware_concurrency());
+                for (int threads : threadCounts) {
+                    benches.push_back({"step/" + bb.label + "/shells:16384/threads:" + std::to_string(threads),
+                                       [path = bb.path, threads](long long n) { return bench_step(path, 16384, threads, n); }});
+                }
+            }
+            for (int maxSteps : {100, 1000}) {
+                benches.push_back({"game/" + bb.label + "/steps:" + std::to_string(maxSteps),
+                                   [path = bb.path, maxSteps](long long n) { return bench_game(path, maxSteps, n); }});
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        fs::remove_all(scratch);
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    if (!listOnly)
+        std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(14) << "Time (ns)"
+              << std::setw(14) << "Iterations" << std::setw(16) << "Items/s" << '\n';
+    for (const auto& [name, body] : benches) {
+        if (name.find(options.filter) == std::string::npos) continue;
+        if (listOnly) {
+            std::cout << name << '\n';
+            continue;
+        }
+        BenchResult r = run_benchmark(name, body, options.minTime);
+        std::ostringstream items;
+        if (r.itemsPerSecond > 0) items << std::fixed << std::setprecision(0) << r.itemsPerSecond;
+        std::cout << std::left << std::setw(48) << r.name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(1) << r.nsPerIteration << std::setw(14) << r.iterations
+                  << std::setw(16) << items.str() << '\n';
+        results.push_back(std::move(r));
+    }
+    fs::remove_all(scratch);
+
+    if (!options.jsonPath.empty()) {
+        try {
+            write_json(options.jsonPath, results);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}